@@ -103,6 +103,7 @@ FlowEventRouter::FlowEventRouter(QWidget *parent, ControlExec *ce) : RenderEvent
             (new PDoubleInput(FP::_firstStepSizeMultiplierTag, "First Step Size Multiplier"))->SetTooltip( "Apply a multiplier to the auto-calculated first step size. Very occasionally a value bigger than 1.0 is needed here."),
             (new PCheckbox(FP::_fixedAdvectionStepTag, "Use Fixed Advection Steps"))->SetTooltip( "The user may provide an advection step size, so that VAPOR disables dynamic step size adjustments and always uses the fixed step size."),
             (new PShowIf(FP::_fixedAdvectionStepTag))->Then(new PDoubleInput(FP::_fixedAdvectionStepSizeTag, "  |--- Fixed Advection Step Size"))->SetTooltip( "Use this specific value as the fixed advection step size."),
+            (new PIntegerInput(FP::ColorSampleStrideTag, "Color Sample Stride"))->SetRange(1, 100)->SetTooltip( "Sample the color mapped variable at every Nth particle only, and interpolate in between. Values above 1 color long flow lines faster, but less accurately."),
         }),
     }));
     
@@ -116,6 +117,7 @@ FlowEventRouter::FlowEventRouter(QWidget *parent, ControlExec *ce) : RenderEvent
                 (new PDoubleSliderEdit(FP::RenderRadiusScalarTag, "Radius Scalar"))->SetRange(0.1, 5)->EnableDynamicUpdate(),
                 new PCheckbox(FP::RenderShowStreamDirTag, "Show Stream Direction"),
                 (new PSubGroup({(new PIntegerSliderEdit(FP::RenderGlyphStrideTag, "Every N Samples"))->SetRange(1, 20)->EnableDynamicUpdate()}))->ShowBasedOnParam(FP::RenderShowStreamDirTag),
+                (new PDoubleSliderEdit(FP::RenderSimplifyToleranceTag, "Simplify (Pixels)"))->SetRange(0, 4)->SetTooltip("Drop flow line vertices that change the rendering by at most this many pixels. 0 turns simplification off."),
             }),
             (new PShowIf(FP::RenderTypeTag))->Equals(FP::RenderTypeSamples)->Then({
                 new PEnumDropdown(FP::RenderGlyphTypeTag, {"Circle", "Arrow"}, {FP::GlpyhTypeSphere, FP::GlpyhTypeArrow}, "Glyph Type"),
@@ -3,6 +3,7 @@
 #include "PWidgets.h"
 #include "PConstantColorWidget.h"
 #include "PCheckbox.h"
+#include <climits>
 
 using namespace VAPoR;
 
@@ -29,7 +30,8 @@ ParticleEventRouter::ParticleEventRouter(QWidget *parent, ControlExec *ce) : Ren
             (new PParticleRadiusVariableSelector()),
         }),
         new PSection("Data Fidelity", {
-            (new PIntegerInput(ParticleParams::StrideTag, "Stride"))->SetRange(1, 1000)
+            (new PIntegerInput(ParticleParams::StrideTag, "Stride"))->SetRange(1, 1000),
+            (new PIntegerInput(ParticleParams::MaxParticlesTag, "Max particles"))->SetRange(0, INT_MAX)->SetTooltip("Thin the particles uniformly to at most this many.\n0 renders all particles.")
         }),
     }));
 
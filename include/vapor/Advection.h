@@ -9,6 +9,7 @@
 #include "vapor/Particle.h"
 #include "vapor/Field.h"
 #include "vapor/common.h"
+#include "vapor/RegularGrid.h"
 #include <string>
 #include <vector>
 
@@ -17,7 +18,8 @@ class FLOW_API Advection final {
 public:
     enum class ADVECTION_METHOD {
         EULER = 0,
-        RK4 = 1    // Runge-Kutta 4th order
+        RK4 = 1,    // Runge-Kutta 4th order
+        RK45 = 2    // Dormand-Prince embedded Runge-Kutta 5(4), with error control
     };
 
     // Constructor and destructor
@@ -29,20 +31,61 @@ public:
     // Advect all particles as long as they are within spatial and temporal boundary
     // for a specified number if steps.
     int AdvectSteps(Field *velocityField, double deltaT, size_t maxSteps, bool fixedStepSize, ADVECTION_METHOD method = ADVECTION_METHOD::RK4);
+    // Advect the streams of this object, and those of "other" with otherDeltaT, as one
+    // parallel job. Used for bi-directional integration, where "other" holds the same
+    // seeds and integrates them backward.
+    int AdvectSteps(Field *velocityField, double deltaT, size_t maxSteps, bool fixedStepSize, Advection &other, double otherDeltaT,
+                    ADVECTION_METHOD method = ADVECTION_METHOD::RK4);
     // Advect as many steps as necessary to reach a certain time: targetT.
     // Note: it only considers particles that have already passed startT.
     int AdvectTillTime(Field *velocityField, double startT, double deltaT, double targetT, bool fixedStepSize, ADVECTION_METHOD method = ADVECTION_METHOD::RK4);
 
+    // Dense-seed batch advection: advect every location in "positions" from time startT
+    // to endT (which may be earlier than startT) in fixed steps of |deltaT|, and replace it
+    // with where it ends up. Only the current state of each seed is kept, so the memory
+    // used does not grow with the number of steps. "valid" records, for each seed, whether
+    // it stayed within the volume (applying periodicity) for the entire time span; an
+    // invalid seed keeps the last location it reached.
+    // This object's own streams are not used.
+    int AdvectFlowMap(Field *velocityField, double startT, double endT, double deltaT,    // Input
+                      std::vector<glm::vec3> &positions,                                  // Input/Output
+                      std::vector<char> &valid,                                           // Output
+                      ADVECTION_METHOD method = ADVECTION_METHOD::RK4) const;
+    // Compute the finite-time Lyapunov exponent (FTLE) of the flow from startT to endT,
+    // on a lattice of "dims" nodes spanning minu to maxu, using AdvectFlowMap() with a seed
+    // at every node. A dimension of length 1 is not seeded along, e.g., dims of (n, m, 1)
+    // give the FTLE within a plane. Nodes whose seed, or whose neighbors' seeds, left the
+    // volume receive the missing value of the returned grid.
+    // The returned grid has a single block, which is "values". Both the grid and "values"
+    // belong to the caller, and "values" must outlive the grid.
+    // Returns nullptr if no seed could be advected.
+    VAPoR::RegularGrid *CalculateFTLE(Field *velocityField, double startT, double endT, double deltaT, const VAPoR::DimsType &dims, const VAPoR::CoordType &minu,
+                                      const VAPoR::CoordType &maxu,    // Input
+                                      std::vector<float> &values,      // Output
+                                      ADVECTION_METHOD method = ADVECTION_METHOD::RK4) const;
+    // The same, but seeded at the nodes of a structured "mesh", e.g., a stretched, layered
+    // or curvilinear grid. The flow map is differentiated with respect to the actual node
+    // locations. "values" receives the FTLE at each node, in the order of the nodes, and
+    // +inf where it's missing. Returns 0 on success.
+    int CalculateFTLE(Field *velocityField, double startT, double endT, double deltaT, const VAPoR::Grid &mesh,    // Input
+                      std::vector<float> &values,                                                                   // Output
+                      ADVECTION_METHOD method = ADVECTION_METHOD::RK4) const;
+
     // Retrieve field values of a particle based on its location, and put the result in
     // the "value" field or the "properties" field of a particle
     //   If "skipNonZero" is true, then this function only overwrites zeros.
     //   Otherwise, it will overwrite values anyway.
-    int CalculateParticleValues(Field *scalarField, bool skipNonZero);
+    //   If "sampleStride" is greater than 1, then only every sampleStride-th particle
+    //   of a stream (and the last particle before a separator) is sampled, and the
+    //   particles in between receive linearly interpolated values. Useful for previews.
+    int CalculateParticleValues(Field *scalarField, bool skipNonZero, size_t sampleStride = 1);
     int CalculateParticleIntegratedValues(Field *scalarField, const bool skipNonZero, const float distScale = 1.f, const std::vector<double> &integrateWithinVolumeMin = {-FLT_MAX, -FLT_MAX, -FLT_MAX},
-                                          const std::vector<double> &integrateWithinVolumeMax = {FLT_MAX, FLT_MAX, FLT_MAX});
+                                          const std::vector<double> &integrateWithinVolumeMax = {FLT_MAX, FLT_MAX, FLT_MAX}, size_t sampleStride = 1);
     void SetAllStreamValuesToFinalValue(int realNSamples);
-    int CalculateParticleProperties(Field *scalarField);
+    int CalculateParticleProperties(Field *scalarField, size_t sampleStride = 1);
 
+    // Count the particle values in bins.size() equal bins over their range, which is
+    // returned in "bounds." The range is kept until the particle values change.
     void CalculateParticleHistogram(std::vector<double> &bounds, std::vector<long> &bins);
 
     // Reset all particle values to zero
@@ -66,6 +109,12 @@ public:
     // Query properties (most are properties of the velocity field)
     int CheckReady() const;
 
+    // Specify error tolerances of the RK45 method. A step is accepted when its error
+    // estimate is at most absTol + relTol * (the distance the step travels).
+    // Without fixed step sizes, the step size then follows the error estimates,
+    // within 1/20X and 20X of deltaT.
+    void SetRK45Tolerance(double relTol, double absTol = 0.0);
+
     // Specify periodicity, and periodic bounds on each dimension
     void SetXPeriodicity(bool, float min, float max);
     void SetYPeriodicity(bool, float min, float max);
@@ -90,11 +139,46 @@ private:
     std::array<bool, 3> _isPeriodic;          // is it periodic in X, Y, Z dimensions?
     std::array<glm::vec2, 3> _periodicBounds; // periodic boundaries in X, Y, Z dimensions
 
+    // What the RK45 method carries from one step of a stream to the next.
+    struct RK45State {
+        double    nextDt = 0.0;    // step size suggested by the error control, 0 if none yet
+        bool      hasK1 = false;   // if k1 holds the velocity at k1Location
+        glm::vec3 k1;              // last stage of the previous step (first same as last)
+        glm::vec3 k1Location;
+    };
+    std::vector<RK45State> _rk45States;    // one per stream
+    double                 _rk45RelTol, _rk45AbsTol;
+
+    std::array<float, 2> _valueRange;               // of the particle values, if _hasValueRange
+    bool                 _hasValueRange = false;    // cleared whenever particle values change
+
     // Advection methods here could assume all input is valid.
     int _advectEuler(Field *, const Particle &, double deltaT,    // Input
                      Particle &p1) const;                         // Output
     int _advectRK4(Field *, const Particle &, double deltaT,      // Input
                    Particle &p1) const;                           // Output
+    // Unless "fixedStepSize" is set, a step whose error estimate exceeds the tolerance
+    // is retried with a smaller deltaT, down to minDt, and deltaT returns the step taken.
+    // A stage that fails also shrinks deltaT; the failure is returned once deltaT is minDt.
+    int _advectRK45(Field *, const Particle &, double &deltaT, double minDt, bool fixedStepSize,    // Input/Output
+                    RK45State &state, Particle &p1) const;                                           // Output
+
+    // Advance stream "streamIdx" by up to maxSteps steps, as part of AdvectSteps().
+    // Returns true if the stream advanced. It can be called concurrently for different streams.
+    bool _advectStreamSteps(Field *, size_t streamIdx, double deltaT, size_t maxSteps, bool fixedStepSize, ADVECTION_METHOD method);
+
+    // Advance stream "streamIdx" until it reaches time endT, as part of AdvectTillTime().
+    // Returns true if the stream terminated (and is marked so) on the way.
+    // Streams are independent, so this function can be called concurrently for
+    // different streams.
+    bool _advectStreamTillTime(Field *, size_t streamIdx, double deltaT, double endT, bool fixedStepSize, ADVECTION_METHOD method,    // Input
+                               size_t maxSteps, size_t &thisStep,                                                                      // Input/Output
+                               bool &happened, bool &hitLimit);                                                                        // Output
+
+    // Advance the seed at "location" from time t0 to t1 in steps of deltaT, which has the
+    // sign of t1 - t0, as part of AdvectFlowMap(). Returns false if it left the volume.
+    bool _advectFlowMapSeed(Field *, double t0, double t1, double deltaT, ADVECTION_METHOD method,    // Input
+                            glm::vec3 &location) const;                                               // Input/Output
 
     // Get an adjust factor for deltaT based on how curvy the past two steps are.
     //   A value in range (0.0, 1.0) means shrink deltaT.
@@ -109,8 +193,20 @@ private:
     // Print return code if it's non-zero and compiled in debug mode.
     void _printNonZero(int rtn, const char *file, const char *func, int line) const;
 
-    void _calculateParticleIntegratedValue(Particle &p, const Particle &prev, const Field *scalarField, const bool skipNonZero, const float distScale,
-                                           const std::vector<double> &integrateWithinVolumeMin, const std::vector<double> &integrateWithinVolumeMax) const;
+    // Sample a scalar field at the particles flagged in "need". Particles are indexed
+    // by their position in the concatenation of all streams, and so are "values",
+    // which receives what GetScalar() wrote, and "valid", which records whether
+    // GetScalar() succeeded. See CalculateParticleValues() for "sampleStride".
+    // Particles in between two samples are sampled directly if either sample failed.
+    void _sampleScalar(Field *scalarField, size_t sampleStride, const std::vector<char> &need,    // Input
+                       std::vector<float> &values, std::vector<char> &valid) const;               // Output
+
+    // Evaluate a scalar field at the listed particles, concurrently. Unsteady fields
+    // are evaluated one pair of bracketing time steps at a time, and each pair is
+    // prepared by Field::PrepareTimeWindow() before it's queried from multiple threads.
+    void _evaluateScalar(Field *scalarField, const std::vector<const Particle *> &parts, const std::vector<size_t> &which,    // Input
+                         std::vector<float> &values, std::vector<char> &valid) const;                                          // Output
+
     static bool _isParticleInsideVolume(const Particle &p, const std::vector<double> &min, const std::vector<double> &max);
 };
 }; // namespace flow
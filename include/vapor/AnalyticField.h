@@ -0,0 +1,120 @@
+/*
+ * Analytic velocity fields, and the same fields sampled on synthetic grids.
+ * They give reproducible inputs for testing and benchmarking flow integration
+ * without a DataMgr.
+ */
+
+#ifndef ANALYTICFIELD_H
+#define ANALYTICFIELD_H
+
+#include "vapor/Field.h"
+#include "vapor/GridField.h"
+#include <memory>
+#include <vector>
+
+namespace flow {
+//
+// A velocity field given by a formula, defined within its domain.
+// Its scalar field is the speed.
+//
+class FLOW_API AnalyticField : public Field {
+public:
+    virtual bool     InsideVolumeVelocity(double time, glm::vec3 pos) const override;
+    virtual bool     InsideVolumeScalar(double time, glm::vec3 pos) const override { return InsideVolumeVelocity(time, pos); }
+    virtual uint32_t GetNumberOfTimesteps() const override { return 1; }
+
+    virtual int GetVelocity(double time, glm::vec3 pos,    // input
+                            glm::vec3 &vel) const override;    // output
+    virtual int GetScalar(double time, glm::vec3 pos,      // input
+                          float &val) const override;       // output
+
+    virtual auto LockParams() -> int override { return 0; }
+    virtual auto UnlockParams() -> int override { return 0; }
+
+    // The velocity at a position, which is not checked against the domain.
+    virtual glm::vec3 Evaluate(double time, glm::vec3 pos) const = 0;
+
+    // The box the field is defined on. SampledField samples the field within it.
+    void GetDomain(glm::vec3 &min, glm::vec3 &max) const;
+
+protected:
+    AnalyticField(glm::vec3 domainMin, glm::vec3 domainMax);
+
+    glm::vec3 _domainMin, _domainMax;
+};
+
+//
+// Arnold-Beltrami-Childress flow. It's steady, and periodic with a period of
+// 2*pi in each dimension. It is defined everywhere; the domain is one period.
+//
+class FLOW_API ABCField final : public AnalyticField {
+public:
+    ABCField(double A = 1.7320508075688772, double B = 1.4142135623730951, double C = 1.0);    // sqrt(3), sqrt(2), 1
+
+    virtual bool      InsideVolumeVelocity(double time, glm::vec3 pos) const override { return true; }
+    virtual glm::vec3 Evaluate(double time, glm::vec3 pos) const override;
+
+private:
+    const double _A, _B, _C;
+};
+
+//
+// The unsteady double gyre on [0, 2] x [0, 1], with a velocity independent of Z.
+// Its domain spans [0, 1] in Z.
+//
+class FLOW_API DoubleGyreField final : public AnalyticField {
+public:
+    DoubleGyreField(double A = 0.1, double epsilon = 0.25, double omega = 0.6283185307179586);    // omega = 2*pi/10
+
+    virtual glm::vec3 Evaluate(double time, glm::vec3 pos) const override;
+
+private:
+    const double _A, _epsilon, _omega;
+};
+
+//
+// Hill's spherical vortex of radius "a", centered at the origin, in a uniform
+// stream of speed U in the -Z direction (i.e., in the frame of the vortex).
+// Streamlines inside the sphere are closed. The domain spans 2a in each direction.
+//
+class FLOW_API HillsVortexField final : public AnalyticField {
+public:
+    HillsVortexField(double a = 1.0, double U = 1.0);
+
+    virtual glm::vec3 Evaluate(double time, glm::vec3 pos) const override;
+
+private:
+    const double _a, _U;
+};
+
+//
+// An analytic field sampled at the nodes of a synthetic grid at each of the
+// given times, and then evaluated through the grids' own point location and
+// interpolation, like data coming from a DataMgr. The grids span the domain
+// of the analytic field with "dims" nodes.
+//
+class FLOW_API SampledField final : public GridField {
+public:
+    enum class GRID_TYPE {
+        REGULAR = 0,
+        STRETCHED = 1,      // coordinates varying nonlinearly along each axis
+        LAYERED = 2,        // Z coordinates varying with X and Y
+        CURVILINEAR = 3     // X and Y coordinates varying with both X and Y
+    };
+
+    SampledField(const AnalyticField &field, GRID_TYPE type, const VAPoR::DimsType &dims, const std::vector<double> &timestamps = {0.0});
+    ~SampledField();
+    SampledField(const SampledField &) = delete;
+    SampledField &operator=(const SampledField &) = delete;
+
+    static const char *GetGridTypeName(GRID_TYPE type);
+
+private:
+    std::vector<std::unique_ptr<float[]>>     _blocks;    // coordinates and values of all grids
+    std::vector<std::unique_ptr<VAPoR::Grid>> _grids;
+
+    float *_allocate(size_t n);
+};
+};    // namespace flow
+
+#endif
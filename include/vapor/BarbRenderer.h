@@ -49,7 +49,7 @@ private:
 
     double _maxValue;
 
-    void _getMagnitudeAtPoint(std::vector<VAPoR::Grid *> variables, float point[3]);
+    double _getMagnitudeAtPoint(const std::vector<VAPoR::Grid *> &variables, const float point[3]) const;
 
     void _recalculateScales(std::vector<VAPoR::Grid *> &varData, int ts);
 
@@ -91,25 +91,26 @@ private:
     //		vector <Grid *> variableData
     //	);
 
-    float _getHeightOffset(Grid *heightVar, float xCoord, float yCoord, bool &missing) const;
+    float _getHeightOffset(const Grid *heightVar, float xCoord, float yCoord, float defaultZ, bool &missing) const;
 
     bool _makeCLUT(float clut[1024]) const;
 
-    void _getDirection(float direction[3], std::vector<Grid *> varData, float xCoord, float yCoord, float zCoord, bool &missing) const;
+    void _getDirection(float direction[3], const std::vector<Grid *> &varData, float xCoord, float yCoord, float zCoord, bool &missing) const;
 
     vector<double> _getScales();
 
     float _calculateLength(float start[3], float end[3]) const;
 
-    void _makeStartAndEndPoint(float start[3], float end[3], float direction[3]);
+    void _makeStartAndEndPoint(const float start[3], float end[3], const float direction[3], const vector<double> &scales, float length) const;
 
     void _getStrides(vector<float> &strides, vector<int> &rakeGrid, vector<float> &rakeExts) const;
 
-    bool _defineBarb(const std::vector<Grid *>, float start[3], float end[3], float *value, bool doColorMapping, const float clut[1024]);
+    //! Sample the field at one rake point. Does not touch params or GL state
+    //! and is safe to call concurrently.
+    //! \retval bool true if the barb has missing data and should be skipped
+    bool _defineBarb(const std::vector<Grid *> &variableData, float start[3], float end[3], float *value, bool doColorMapping, const vector<double> &scales, float length, float defaultZ) const;
 
-    void _operateOnGrid(vector<Grid *> variableData, bool drawBarb = true);
-
-    bool _getColorMapping(float val, const float clut[256 * 4]);
+    void _operateOnGrid(const vector<Grid *> &variableData, bool drawBarb = true);
 
     float _calculateDirVec(const float start[3], const float end[3], float dirVec[3]);
 
@@ -119,16 +120,12 @@ private:
 
     void _drawBarbHead(const float dirVec[3], const float vertexPoint[3], const float startNormal[3], const float startVertex[3]) const;
 
-    //! Protected method to draw one barb (a hexagonal tube with a cone barbhead)
-    //! \param[in] const float startPoint[3] beginning position of barb
-    //! \param[in] const float endPoint[3] ending position of barb
-    // void drawBarb(const float startPoint[3], const float endPoint[3]);
-    void _drawBarb(const std::vector<Grid *> variableData, const float startPoint[3], bool doColorMapping, const float clut[1024]);
-
     void _setBarbColor(float value, const float clut[1024], double crange[2]) const;
 
     struct Barb;
-    void _drawBarb(Barb b, bool doColorMapping, const float clut[1024], double crange[2]);
+    //! Draw one cached barb (a hexagonal tube with a cone barbhead).
+    //! \param[in] scales, radius, lengthScalar Per-frame values, computed once by the caller
+    void _drawBarb(Barb b, bool doColorMapping, const float clut[1024], double crange[2], const vector<double> &scales, float radius, float lengthScalar);
 
 #ifdef DEBUG
     _printBackDiameter(const float startVertex[18]) const;
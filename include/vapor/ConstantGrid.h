@@ -26,11 +26,12 @@ public:
     // Useful functions of ConstantGrid.
     // Additional ones could be added when needed.
     //
-    // The following four GetValue methods all return the constant value of this grid.
+    // The following five GetValue methods all return the constant value of this grid.
     float GetConstantValue() const;
     float GetValue(const CoordType &coords) const override;
     float GetValueNearestNeighbor(const CoordType &coords) const override;
     float GetValueLinear(const CoordType &coords) const override;
+    float GetValueAtLocation(const PointLocation &loc) const override;
 
     // This version of ConstantGrid is considered to have infinity extents,
     // so the following method will return numerical mins and maxes.
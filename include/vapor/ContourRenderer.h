@@ -76,12 +76,45 @@ private:
 
     } _cacheParams;
 
+    //! Cells of the contoured grid that have no missing values, flattened
+    //! so that isovalues can be marched without re-reading the grid.
+    //! Nodes are stored once (x, y, z, value per node, with z already
+    //! resolved from the height variable or default Z); cell \p c
+    //! references nodes cellNodes[cellStart[c]] .. cellNodes[cellStart[c+1]-1].
+    //! Cells are grouped into blocks (the grid's data blocks when possible,
+    //! runs of consecutive cells otherwise); block \p b holds cells
+    //! blockStart[b] .. blockStart[b+1]-1 and its value range is kept in
+    //! blockMin/blockMax so that a new isovalue only visits blocks that
+    //! can contain it.
+    //
+    struct {
+        vector<float>  nodes;
+        vector<size_t> cellNodes;
+        vector<size_t> cellStart;
+        vector<size_t> blockStart;
+        vector<float>  blockMin, blockMax;
+    } _cellIndex;
+
+    //! Line segments for a single isovalue and the slice of the VBO
+    //! (in vertices) they occupy
+    //
+    struct ContourLevel {
+        double        value;
+        vector<float> vertices;
+        size_t        offset;
+    };
+    vector<ContourLevel> _levels;
+    size_t               _bufferCapacity;
+    size_t               _bufferUsed;
+
     int  _buildCache(bool fast);
     bool _isCacheDirty() const;
     void _saveCacheParams();
+    void _buildCellIndex(const Grid *grid, const Grid *heightGrid, const vector<float> &gridBlockMins, const vector<float> &gridBlockMaxs, const CoordType &boxMin, const CoordType &boxMax, bool is2D, float defaultZ);
+    void _marchLevel(float contour, vector<float> &vertices) const;
+    void _updateLevels(const vector<double> &contours);
 
     void _clearCache() { _cacheParams.varName.clear(); }
-
     vector<glm::vec3> _sliceQuad;
     glm::vec3         _finalOrigin;
 };
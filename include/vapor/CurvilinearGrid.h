@@ -182,6 +182,14 @@ public:
     //
     virtual bool InsideGrid(const CoordType &coords) const override;
 
+    //! \copydoc Grid::LocatePoint()
+    //
+    virtual void LocatePoint(const CoordType &coords, PointLocation &loc) const override;
+
+    //! \copydoc Grid::GetValueAtLocation()
+    //
+    virtual float GetValueAtLocation(const PointLocation &loc) const override;
+
     //! Returns reference to RegularGrid instance containing X user coordinates
     //!
     //! Returns reference to RegularGrid instance passed to constructor
@@ -203,6 +211,22 @@ public:
     //!
     const std::vector<double> &GetZCoords() const { return (_zcoords); };
 
+    //! Returns reference to RegularGrid instance containing Z user coordinates
+    //!
+    //! Returns reference to RegularGrid instance passed to constructor
+    //! containing Z user coordinates. Only meaningful if
+    //! IsTerrainFollowing() returns true
+    //!
+    const RegularGrid &GetZRG() const { return (_zrg); };
+
+    //! Returns true if Z user coordinates vary horizontally
+    //!
+    //! Returns true if the grid was constructed with a RegularGrid of Z
+    //! user coordinates (see GetZRG()), false if the Z coordinates are
+    //! given by GetZCoords()
+    //!
+    bool IsTerrainFollowing() const { return (_terrainFollowing); };
+
     class ConstCoordItrCG : public Grid::ConstCoordItrAbstract {
     public:
         ConstCoordItrCG(const CurvilinearGrid *cg, bool begin);
@@ -263,6 +287,10 @@ private:
 
     bool _insideGrid(double x, double y, double z, size_t &i, size_t &j, size_t &k, double lambda[4], double zwgt[2]) const;
 
+    float _getValueQuad(size_t i, size_t j, size_t k, const double lambda[4], const double zwgt[2]) const;
+
+    float _getValueNearestNeighborQuad(size_t i, size_t j, size_t k, const double lambda[4], const double zwgt[2]) const;
+
     void _getIndicesHelper(const std::vector<double> &coords, std::vector<size_t> &indices) const;
 
     bool _insideGridHelperStretched(double z, size_t &k, double zwgt[2]) const;
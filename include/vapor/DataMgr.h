@@ -505,6 +505,22 @@ public:
     //
     int GetDataRange(size_t ts, string varname, int level, int lod, CoordType min, CoordType max, std::vector<double> &range);
 
+    //! Compute the per-block value ranges of a variable within a specified ROI
+    //!
+    //! This method returns the cell value range of each data block of the
+    //! grid returned by DataMgr::GetVariable() for the same arguments. The
+    //! results are equivalent to calling Grid::GetBlockCellRanges()
+    //! on that grid, and may be used to skip blocks that cannot contain a
+    //! crossing of a given value (e.g. when extracting contours). Results
+    //! are computed in parallel and cached with the region.
+    //!
+    //! \param[out] mins Minimum value of each block of the grid
+    //! \param[out] maxs Maximum value of each block of the grid
+    //!
+    //! \sa Grid::GetBlockCellRanges(), GetDataRange()
+    //
+    int GetBlockDataRanges(size_t ts, string varname, int level, int lod, CoordType min, CoordType max, std::vector<float> &mins, std::vector<float> &maxs);
+
     //! \copydoc DC::GetDimLensAtLevel()
     //!
     virtual int GetDimLensAtLevel(string varname, int level, std::vector<size_t> &dims_at_level, long ts) const
@@ -0,0 +1,48 @@
+/*
+ * A derived data variable holding the finite-time Lyapunov exponent (FTLE)
+ * of a velocity field. It is exposed through DataMgr::AddDerivedVar().
+ */
+
+#ifndef DERIVEDFTLE_H
+#define DERIVEDFTLE_H
+
+#include "vapor/DerivedVar.h"
+#include "vapor/DataMgr.h"
+#include "vapor/Advection.h"
+#include <string>
+#include <vector>
+
+namespace flow {
+//
+// The FTLE is computed at each time step from the velocity there, held steady,
+// over an integration time of "duration" taken in "steps" RK4 steps. A negative
+// duration gives the backward FTLE. It lives on the mesh of the first velocity
+// variable, which must be structured, and is computed at its nodes.
+// An empty velocity name stands for a zero component.
+//
+class FLOW_API DerivedFTLE : public VAPoR::DerivedDataVar {
+public:
+    DerivedFTLE(std::string varName, VAPoR::DataMgr *dataMgr, const std::vector<std::string> &velocityNames, double duration, size_t steps = 100);
+
+    virtual int                      Initialize() override;
+    virtual bool                     GetBaseVarInfo(VAPoR::DC::BaseVar &var) const override;
+    virtual bool                     GetDataVarInfo(VAPoR::DC::DataVar &dvar) const override;
+    virtual std::vector<std::string> GetInputs() const override;
+    virtual int                      GetDimLensAtLevel(int level, std::vector<size_t> &dims_at_level, std::vector<size_t> &bs_at_level) const override;
+    virtual size_t                   GetNumRefLevels() const override;
+    virtual std::vector<size_t>      GetCRatios() const override;
+    virtual int                      OpenVariableRead(size_t ts, int level = 0, int lod = 0) override;
+    virtual int                      CloseVariable(int fd) override;
+    virtual int                      ReadRegion(int fd, const std::vector<size_t> &min, const std::vector<size_t> &max, float *region) override;
+    virtual bool                     VariableExists(size_t ts, int reflevel, int lod) const override;
+
+private:
+    VAPoR::DataMgr *         _dataMgr;
+    std::vector<std::string> _velocityNames;    // 3 names, possibly empty
+    double                   _duration;
+    size_t                   _steps;
+    VAPoR::DC::DataVar       _velocityInfo;     // of the first velocity variable
+};
+};    // namespace flow
+
+#endif
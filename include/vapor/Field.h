@@ -7,6 +7,7 @@
 
 #include <string>
 #include <array>
+#include <vector>
 #include <glm/glm.hpp>
 #include <vapor/common.h>
 
@@ -29,6 +30,31 @@ public:
     //
     virtual uint32_t GetNumberOfTimesteps() const = 0;
 
+    //
+    // Retrieve the time stamps of this field, in ascending order.
+    // Fields without time stamps return an empty vector.
+    //
+    virtual std::vector<double> GetTimestamps() const { return std::vector<double>(); }
+
+    //
+    // Prepare the field to be queried at times within [t0, t1], which
+    // lie within one pair of bracketing time steps. Integrators call this
+    // serially before querying the field from multiple threads, so that
+    // any data those queries need is already loaded. Steady fields prepare
+    // the data of their current time step regardless of the window.
+    // "prefetchNext" tells that the caller goes on to a later window after this
+    // one, so a field may start loading the data of that window in the background.
+    // It returns 0 on success.
+    //
+    virtual int PrepareTimeWindow(double t0, double t1, bool prefetchNext = false) const { return 0; }
+
+    //
+    // Integrators call this after the last time window they prepared. A field
+    // that loads data for upcoming windows in the background waits for that
+    // loading here, so that none of it runs once the integrator returns.
+    //
+    virtual void FinishTimeWindows() const {}
+
     //
     // Get the field value at a certain position, at a certain time.
     //
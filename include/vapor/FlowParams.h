@@ -368,6 +368,24 @@ public:
     //! Valid values: INT_MIN to INT_MAX.
     static const std::string RenderFadeTailLengthTag;
 
+    //! Simplifies flow lines before they are drawn, allowing them to deviate from the
+    //! integrated paths by up to this many pixels on screen. Vertices where the color
+    //! mapped value changes by more than one color map entry are kept. Only applies
+    //! to streams drawn without direction glyphs or faded tails.
+    //! Applies data of type: double.
+    //! Typical values: 0.5 to 2.0.
+    //! Valid values: 0 (off) to DBL_MAX.
+    static const std::string RenderSimplifyToleranceTag;
+
+    //! Samples the color mapped variable at only every N-th particle of a flow line,
+    //! and linearly interpolates the particles in between. Speeds up coloring long
+    //! flow lines at the expense of accuracy. Flow lines written to file are always
+    //! sampled at every particle.
+    //! Applies data of type: long.
+    //! Typical values: 1 to 8.
+    //! Valid values: 1 (off) to LONG_MAX.
+    static const std::string ColorSampleStrideTag;
+
     //! Specifies the Phong Ambient lighting coefficient (https://en.wikipedia.org/wiki/Phong_reflection_model).
     //! Applies data of type: double.
     //! Typical values: 0.0 to 1.0.
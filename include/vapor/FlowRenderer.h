@@ -81,6 +81,7 @@ private:
     bool                _cache_integrationSetAllToFinalValue;
     float               _cache_integrationDistScalar;
     std::vector<double> _cache_integrationVolume;
+    size_t              _cache_colorSampleStride = 1;
     bool                _cache_useFixedAdvectionSteps = false;
     double              _cache_fixedAdvectionStepSize = 0.0;
 
@@ -98,6 +99,25 @@ private:
     unsigned int _VBO = 0;
     vector<int>  _streamSizes;
 
+    // Flow lines in the layout uploaded to the GPU. Every stretch of a stream between
+    // separators is a line strip, with an extra vertex on each end for adjacency.
+    struct FlowlineVertex {
+        glm::vec3 p;
+        float     v;
+    };
+    struct FlowlineCache {
+        std::vector<FlowlineVertex> vertices;
+        std::vector<int>            sizes;
+        float                       pixels = 0.f;            // simplification tolerance setting, in pixels
+        float                       tolerance = 0.f;         // simplification tolerances used
+        float                       valueTolerance = 0.f;
+        bool                        valid = false;
+    };
+    // The (simplified) flow lines of _advection and _2ndAdvection. They are rebuilt
+    // with the streams, when the tolerance setting changes, or when the view changes
+    // the tolerance in data space considerably.
+    FlowlineCache _flowlineCaches[2];
+
     //
     // Member functions
     //
@@ -109,6 +129,8 @@ private:
     int       _renderFromAnAdvectionLegacy(const flow::Advection *, FlowParams *, bool fast);
     int       _renderAdvection(const flow::Advection *adv);
     int       _renderAdvectionHelper(bool renderDirection = false);
+    void      _buildFlowlines(const flow::Advection *adv, float tolerance, float valueTolerance, FlowlineCache &cache) const;
+    float     _getSimplifyTolerance(FlowParams *);
     void      _prepareColormap(FlowParams *);
     void      _particleHelper1(std::vector<float> &vec, const flow::Particle &p, bool singleColor) const;
     int       _drawALineStrip(const float *buf, size_t numOfParts, bool singleColor) const;
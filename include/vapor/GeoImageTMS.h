@@ -11,6 +11,8 @@
 #endif
 #include <sstream>
 #include <fstream>
+#include <list>
+#include <map>
 #include <sys/stat.h>
 #include <vapor/MyBase.h>
 #include <vapor/UDUnitsClass.h>
@@ -38,6 +40,15 @@ public:
     unsigned char *GetImage(size_t ts, const double pcsExtentsReq[4], string proj4StringReq, size_t maxWidthReq, size_t maxHeightReq, double pcsExtentsImg[4], double geoCornersImg[8],
                             string &proj4StringImg, size_t &width, size_t &height);
 
+    //! Set the maximum number of decoded tiles kept in memory
+    //!
+    //! Decoded tiles are kept between calls to GetImage() and evicted in
+    //! least recently used order once more than \p n tiles are held. Tiles
+    //! used by the most recent request are never evicted, so a single
+    //! large request may exceed the limit. The default is 256 tiles.
+    //
+    void SetTileCacheSize(size_t n);
+
 private:
     string _dir;           // path to TMS directory
     int    _maxLOD;        // Maximum LOD available in TMS
@@ -46,11 +57,16 @@ private:
     unsigned char *_texture;    // storage for texture image
     size_t         _textureSize;
 
-    unsigned char *_tileBuf;    // storage for a single tile
-    size_t         _tileBufSize;
-
     GeoTileMercator *_geotile;
 
+    // LRU bookkeeping for the tiles held by _geotile. Not thread safe: it is
+    // only used by the thread calling GetImage(), never from within the
+    // parallel tile decoding, and so needs no lock.
+    //
+    size_t                                        _maxCachedTiles;
+    std::list<string>                             _lruTiles;    // quadkeys, most recently used first
+    std::map<string, std::list<string>::iterator> _lruIndex;
+
     string _defaultProj4String;    // proj4 string for global mercator
 
     int _tileSize(string dir, size_t tileX, size_t tileY, int lod, size_t &w, size_t &h);
@@ -60,6 +76,16 @@ private:
     int _getBestLOD(const double myGeoExtentsData[4], int maxWidthReq, int maxHeightReq) const;
 
     int _getMap(const size_t pixelSW[2], const size_t pixelNE[2], int lod, unsigned char *texture);
+
+    void _mapTiles(const size_t pixelSW[2], const size_t pixelNE[2], int lod, vector<string> &quadkeys) const;
+
+    int _loadTiles(const vector<string> &quadkeys);
+
+    void _touchTiles(const vector<string> &quadkeys);
+
+    void _evictTiles(size_t nPinned);
+
+    void _clearTiles();
 };
 
 };    // namespace VAPoR
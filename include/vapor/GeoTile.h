@@ -73,6 +73,17 @@ public:
     //
     int Insert(std::string quadkey, const unsigned char *image);
 
+    //! Remove an image tile from the class object
+    //!
+    //! Frees the image tile associated with \p quadkey. Nothing is done
+    //! if no such tile has been inserted.
+    //!
+    //! \param[in] quadkey A Quad Key
+    //!
+    //! \sa Insert()
+    //
+    void Erase(std::string quadkey);
+
     //! Converts a point from latitude/longitude WGS-84 coordinates (in degrees)
     //! into pixel XY coordinates at a specified level of detail.
     //!
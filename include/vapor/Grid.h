@@ -272,6 +272,62 @@ public:
         return (GetValue(coords));
     }
 
+    //! Cell location and interpolation weights of a point
+    //!
+    //! A PointLocation is produced by LocatePoint() and consumed by
+    //! GetValueAtLocation(). It lets the (possibly expensive) cell search
+    //! be performed once and the result applied to any number of grids
+    //! that share the same node layout: the same coordinate variables,
+    //! grid type, node dimensions, and minimum absolute index.
+    //!
+    //! \sa LocatePoint(), GetValueAtLocation()
+    //
+    class PointLocation {
+    public:
+        //! OUTSIDE : point is outside of the grid
+        //! CELL : \a indices and \a wgts are trilinear cell weights
+        //! QUAD : \a indices, \a wgts (Wachspress), and \a zwgt are
+        //! curvilinear cell weights
+        //! COORDS : the search was not performed; \a coords is used
+        //
+        enum Kind { OUTSIDE, CELL, QUAD, COORDS };
+
+        Kind      kind = OUTSIDE;
+        DimsType  indices = {{0, 0, 0}};
+        double    wgts[4] = {0.0, 0.0, 0.0, 0.0};
+        double    zwgt[2] = {1.0, 0.0};
+        CoordType coords = {{0.0, 0.0, 0.0}};
+    };
+
+    //! Locate a point in the grid once, for sampling several grids
+    //!
+    //! This method performs the cell search and weight computation
+    //! of GetValue() and stores the result in \p loc. Periodic
+    //! coordinates are clamped as with GetValue(). Grid classes that
+    //! don't provide a specialized search record the clamped coordinates
+    //! and defer the search to GetValueAtLocation().
+    //!
+    //! \param[in] coords Coordinates of the point
+    //! \param[out] loc Location of the point
+    //!
+    //! \sa GetValueAtLocation()
+    //
+    virtual void LocatePoint(const CoordType &coords, PointLocation &loc) const;
+
+    //! Reconstruct a value at a previously located point
+    //!
+    //! Returns the same value as GetValue() would for the point passed
+    //! to LocatePoint(), provided \p loc was produced by this grid or by
+    //! a grid sharing its node layout. The reconstruction method is
+    //! determined by this grid's interpolation order. If the point is
+    //! outside of the grid the \a missing_value is returned.
+    //!
+    //! \param[in] loc Location returned by LocatePoint()
+    //!
+    //! \sa LocatePoint(), GetValue()
+    //
+    virtual float GetValueAtLocation(const PointLocation &loc) const;
+
     //! Return the extents of the user coordinate system
     //!
     //! This pure virtual method returns min and max extents of
@@ -555,6 +611,33 @@ public:
         GetRange(min3, max3, range);
     }
 
+    //! Compute the range of the cell values contained in each data block
+    //!
+    //! For every block of the grid this method returns the minimum and
+    //! maximum of the node values referenced by cells whose first (smallest
+    //! index) node lies in the block. Hence the range of a block includes
+    //! the first node layer of its neighbors along each axis, and a cell
+    //! can only contain a crossing of a value \e v (an edge with one node
+    //! <= \e v and the other > \e v) if \e v lies within
+    //! [\p mins[b], \p maxs[b]) of its block \e b. Blocks failing that
+    //! test may be skipped entirely by contouring and isosurface code.
+    //!
+    //! Values equal to the missing value are ignored. Blocks that contain
+    //! no valid values are given an empty range, with the minimum greater
+    //! than the maximum. For dataless grids both vectors are empty.
+    //!
+    //! The block ranges are computed in parallel. Only meaningful for
+    //! grids with structured cell topology.
+    //!
+    //! \param[out] mins Minimum value of each block, ordered with the
+    //! X block index varying fastest. The vector has one element for each of
+    //! the GetDimensionInBlks() blocks.
+    //! \param[out] maxs Maximum value of each block
+    //!
+    //! \sa GetRange(), GetBlockSize(), GetDimensionInBlks()
+    //
+    virtual void GetBlockCellRanges(std::vector<float> &mins, std::vector<float> &maxs) const;
+
     //! Return true if the specified point lies inside the grid
     //!
     //! This method can be used to determine if a point expressed in
@@ -1213,6 +1296,58 @@ public:
 
     ConstIterator cend() const { return (ConstIterator(this, false)); }
 
+    //! Visit contiguous runs of data values within a region of the grid
+    //!
+    //! This method provides a non-polymorphic alternative to the
+    //! value iterators for traversing grid data. The functor \p f is
+    //! invoked once for each run of data values that are contiguous in
+    //! memory, with the signature:
+    //!
+    //! \code void f(const float *values, size_t n, const DimsType &index) \endcode
+    //!
+    //! where \p values points to the first of \p n values, and \p index
+    //! gives the grid index of the first value in the run. The remaining
+    //! values in a run have indices (index[0]+1, index[1], index[2]),
+    //! (index[0]+2, index[1], index[2]), etc. Each run lies within a single
+    //! row of a single block, so runs never exceed GetBlockSize()[0] values.
+    //!
+    //! Runs are visited in block order (blocks ordered by the slowest
+    //! varying block index, then rows within each block), not in the
+    //! order used by the value iterators. Callers needing raster order
+    //! should use cbegin()/cend().
+    //!
+    //! The traversal is valid for all grid types whose data are stored in
+    //! blocks (RegularGrid, StretchedGrid, LayeredGrid, CurvilinearGrid,
+    //! etc.) and does not invoke any virtual methods, allowing the
+    //! compiler to vectorize the inner loop of \p f. Dataless grids
+    //! produce no runs. The missing value is not treated specially.
+    //!
+    //! \param[in] min Minimum grid index of region, inclusive. Clamped to
+    //! the grid dimensions
+    //! \param[in] max Maximum grid index of region, inclusive. Clamped to
+    //! the grid dimensions
+    //! \param[in] f Functor invoked for each run
+    //!
+    //! \sa GetBlockSize(), GetDimensions(), cbegin()
+    //
+    template<typename F> void ForEachBlockRun(const DimsType &min, const DimsType &max, F &&f) const { _forEachBlockRun<const float>(min, max, f); }
+
+    //! \copydoc ForEachBlockRun()
+    //!
+    //! Non-const variant. \p values is a \c float* that may be used to modify
+    //! grid data in place.
+    //
+    template<typename F> void ForEachBlockRun(const DimsType &min, const DimsType &max, F &&f) { _forEachBlockRun<float>(min, max, f); }
+
+    //! Visit contiguous runs of all data values in the grid
+    //!
+    //! Equivalent to ForEachBlockRun(min, max, f) with \p min and \p max
+    //! set to the first and last grid index, respectively.
+    //
+    template<typename F> void ForEachBlockRun(F &&f) const { _forEachBlockRun<const float>({0, 0, 0}, {_dims[0] - 1, _dims[1] - 1, _dims[2] - 1}, f); }
+
+    template<typename F> void ForEachBlockRun(F &&f) { _forEachBlockRun<float>({0, 0, 0}, {_dims[0] - 1, _dims[1] - 1, _dims[2] - 1}, f); }
+
     template<typename T> static void CopyToArr3(const std::vector<T> &src, std::array<T, 3> &dst)
     {
         for (int i = 0; i < src.size() && i < dst.size(); i++) { dst[i] = src[i]; }
@@ -1288,6 +1423,47 @@ private:
     mutable CoordType    _maxuCache = {{std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()}};
 
     void _grid(const DimsType &dims, const DimsType &bs, const std::vector<float *> &blks, size_t topology_dimension);
+
+    template<typename T, typename F> void _forEachBlockRun(const DimsType &min, const DimsType &max, F &f) const
+    {
+        if (!_blks.size()) return;
+
+        DimsType cMin, cMax;
+        for (int i = 0; i < 3; i++) {
+            cMin[i] = std::min(min[i], _dims[i] - 1);
+            cMax[i] = std::min(max[i], _dims[i] - 1);
+            if (cMin[i] > cMax[i]) return;
+        }
+
+        DimsType index;
+        for (size_t bz = cMin[2] / _bs[2]; bz <= cMax[2] / _bs[2]; bz++) {
+            size_t k0 = std::max(cMin[2], bz * _bs[2]);
+            size_t k1 = std::min(cMax[2], (bz + 1) * _bs[2] - 1);
+
+            for (size_t by = cMin[1] / _bs[1]; by <= cMax[1] / _bs[1]; by++) {
+                size_t j0 = std::max(cMin[1], by * _bs[1]);
+                size_t j1 = std::min(cMax[1], (by + 1) * _bs[1] - 1);
+
+                for (size_t bx = cMin[0] / _bs[0]; bx <= cMax[0] / _bs[0]; bx++) {
+                    size_t i0 = std::max(cMin[0], bx * _bs[0]);
+                    size_t i1 = std::min(cMax[0], (bx + 1) * _bs[0] - 1);
+                    size_t n = i1 - i0 + 1;
+
+                    T *blk = _blks[bz * _bdims[0] * _bdims[1] + by * _bdims[0] + bx];
+
+                    index[0] = i0;
+                    for (size_t k = k0; k <= k1; k++) {
+                        index[2] = k;
+                        for (size_t j = j0; j <= j1; j++) {
+                            index[1] = j;
+                            T *run = blk + ((k - bz * _bs[2]) * _bs[1] + (j - by * _bs[1])) * _bs[0] + (i0 - bx * _bs[0]);
+                            f(run, n, static_cast<const DimsType &>(index));
+                        }
+                    }
+                }
+            }
+        }
+    }
 };
 
 template void Grid::CopyToArr3<size_t>(const std::vector<size_t> &src, std::array<size_t, 3> &dst);
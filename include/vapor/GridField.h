@@ -0,0 +1,51 @@
+/*
+ * A velocity field made of grids that are already in memory, e.g., retrieved
+ * from a DataMgr or built synthetically. It does not own the grids.
+ */
+
+#ifndef GRIDFIELD_H
+#define GRIDFIELD_H
+
+#include "vapor/Field.h"
+#include "vapor/Particle.h"
+#include "vapor/Grid.h"
+#include <array>
+#include <vector>
+
+namespace flow {
+class FLOW_API GridField : public Field {
+public:
+    GridField();
+
+    // Add the grids of the three velocity components at a time step, which is
+    // later than all time steps added before. A null grid is a zero component.
+    // With a single time step, the field is steady.
+    // The grids must outlive this object.
+    void AddTimestep(double time, const VAPoR::Grid *u, const VAPoR::Grid *v, const VAPoR::Grid *w);
+
+    virtual bool                InsideVolumeVelocity(double time, glm::vec3 pos) const override;
+    virtual bool                InsideVolumeScalar(double time, glm::vec3 pos) const override { return false; }
+    virtual uint32_t            GetNumberOfTimesteps() const override { return _timestamps.size(); }
+    virtual std::vector<double> GetTimestamps() const override { return _timestamps; }
+
+    // Unsteady fields are interpolated linearly in time.
+    virtual int GetVelocity(double time, glm::vec3 pos,    // input
+                            glm::vec3 &vel) const override;    // output
+    virtual int GetScalar(double time, glm::vec3 pos,      // input
+                          float &val) const override { return NO_FIELD_YET; }
+
+    virtual auto LockParams() -> int override { return 0; }
+    virtual auto UnlockParams() -> int override { return 0; }
+
+private:
+    std::vector<double>                            _timestamps;
+    std::vector<std::array<const VAPoR::Grid *, 3>> _grids;    // one triplet per time step
+
+    // Locate the time steps bracketing "time". Returns false if it's out of range.
+    bool _locateTimestep(double time, size_t &floor) const;
+    bool _insideAtTimestep(size_t ts, const VAPoR::CoordType &coords) const;
+    int  _getVelocityAtTimestep(size_t ts, const VAPoR::CoordType &coords, glm::vec3 &vel) const;
+};
+};    // namespace flow
+
+#endif
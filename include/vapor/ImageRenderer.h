@@ -40,6 +40,7 @@ private:
     int            _cacheLod;
     int            _cacheTMSLOD;
     vector<double> _cacheBoxExtents;
+    double         _cacheDefaultZ;
     size_t         _cacheTimestepTex;
     string         _cacheHgtVar;
     int            _cacheGeoreferenced;
@@ -54,11 +55,15 @@ private:
 
     unsigned char *_getTexture(DataMgr *dataMgr);
 
-    bool _gridStateDirty() const;
+    //! The mesh is rebuilt when the ROI, refinement, height variable or
+    //! default Z change, or when the time step changes and the height
+    //! variable is time-varying
+    //
+    bool _gridStateDirty(DataMgr *dataMgr) const;
 
     void _gridStateClear();
 
-    void _gridStateSet();
+    void _gridStateSet(DataMgr *dataMgr, double defaultZ);
 
     bool _imageStateDirty(const vector<double> &times) const;
 
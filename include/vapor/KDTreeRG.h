@@ -3,6 +3,7 @@
 
 #include <ostream>
 #include <vector>
+#include <memory>
 #include <vapor/Grid.h>
 
 #include "nanoflann.hpp"
@@ -55,7 +56,7 @@ public:
     //!
     //! \sa KDTreeRG(const Grid, const Grid)
     //
-    // KDTreeRG( const Grid &xg, const Grid &yg, const Grid &zg );
+    KDTreeRG(const Grid &xg, const Grid &yg, const Grid &zg);
 
     virtual ~KDTreeRG();
 
@@ -67,19 +68,41 @@ public:
     //! Grid instances passed into the constructor.
     //!
     //! \param[in] coordu A 2D or 3D vector of user coordinates specifying
-    //! the location of a point in space.
+    //! the location of a point in space. The size of \p coordu must
+    //! match the dimension of the tree as returned by GetNumCoords()
     //!
     //! \param[out] index The \a ijk indecies of the grid vertex nearest
     //! \p coordu.
     //
     void Nearest(const std::vector<float> &coordu, std::vector<size_t> &index) const;
 
-    void Nearest(const std::vector<double> &coordu, std::vector<size_t> &index) const
-    {
-        std::vector<float> coordu_f;
-        for (int i = 0; i < coordu.size(); i++) coordu_f.push_back(coordu[i]);
-        this->Nearest(coordu_f, index);
-    }
+    void Nearest(const std::vector<double> &coordu, std::vector<size_t> &index) const;
+
+    //! Find the k nearest points for a batch of query points
+    //!
+    //! This method performs a k-nearest-neighbor search for each of
+    //! \p n query points. Queries are independent and are processed
+    //! in parallel when OpenMP is enabled. No memory is allocated by this
+    //! method; all results are written to the caller supplied arrays.
+    //!
+    //! \param[in] coordu An array of \p n * GetNumCoords() user coordinates.
+    //! The coordinates of each point are stored contiguously, e.g.
+    //! x0, y0, z0, x1, y1, z1, ...
+    //! \param[in] n The number of query points
+    //! \param[in] k The number of neighbors to find for each query point.
+    //! \p k must be in the range 1 to GetNumPoints()
+    //! \param[out] indices An array with space for \p n * \p k elements. On
+    //! return contains, for each query point, the linear offsets of the \p k
+    //! nearest grid vertices, ordered by increasing distance. A linear
+    //! offset may be converted to \a ijk indices with Wasp::VectorizeCoords()
+    //! and the dimensions returned by GetDimensions().
+    //! \param[out] distances An array with space for \p n * \p k elements.
+    //! On return contains the squared Cartesian distance between each
+    //! query point and the corresponding entry of \p indices.
+    //!
+    //! \sa GetNumCoords()
+    //
+    void Nearest(const float *coordu, size_t n, size_t k, size_t *indices, float *distances) const;
 
     //! Returns the dimesionality of the structured grids passed to the
     //! constructor.
@@ -91,49 +114,27 @@ public:
     //! \retval vector
     std::vector<size_t> GetDimensions() const { return (_dims); }
 
+    //! Return the number of coordinates (2 or 3) of each point in the tree
+    //
+    int GetNumCoords() const { return (_points.GetNumCoords()); }
+
+    //! Return the number of points in the tree
+    //
+    size_t GetNumPoints() const { return (_points.kdtree_get_point_count()); }
+
 private:
-    class PointCloud2D {
+    class PointCloud {
     public:
-        // Constructor
-        PointCloud2D(const Grid &xg, const Grid &yg)
-        {
-            VAssert(xg.GetDimensions() == yg.GetDimensions());
-            VAssert(xg.GetNumDimensions() <= 2);
-
-            // number of elements
-            auto   dims = xg.GetDimensions();
-            size_t nelem = 1;
-            for (int i = 0; i < dims.size(); i++) nelem *= dims[i];
-            this->X.resize(nelem);
-            this->Y.resize(nelem);
-
-            // Store the point coordinates in the k-d tree
-            Grid::ConstIterator xitr = xg.cbegin();
-            Grid::ConstIterator yitr = yg.cbegin();
-
-            for (size_t i = 0; i < nelem; ++i, ++xitr, ++yitr) {
-                this->X[i] = *xitr;
-                this->Y[i] = *yitr;
-            }
-        }    // end of the Constructor
+        // Store the point coordinates, interleaved, in the order given
+        // by the linear offset of each grid vertex
+        //
+        PointCloud(const std::vector<const Grid *> &coordGrids);
 
         // Must return the number of data points
-        inline size_t kdtree_get_point_count() const
-        {
-            VAssert(X.size() == Y.size());
-            return X.size();
-        }
+        inline size_t kdtree_get_point_count() const { return _coords.size() / _nCoords; }
 
         // Returns the dim'th component of the idx'th point in the class:
-        // Since this is inlined and the "dim" argument is typically an immediate value, the
-        //  "if/else's" are actually solved at compile time.
-        inline float kdtree_get_pt(const size_t idx, int dim) const
-        {
-            if (dim == 0)
-                return X[idx];
-            else
-                return Y[idx];
-        }
+        inline float kdtree_get_pt(const size_t idx, int dim) const { return _coords[idx * _nCoords + dim]; }
 
         // Optional bounding-box computation: return false to default to a standard bbox computation loop.
         //   Return true if the BBOX was already computed by the class and returned in "bb"
@@ -141,16 +142,23 @@ private:
         //   Look at bb.size() to find out the expected dimensionality (e.g. 2 or 3 for point clouds)
         template<class BBOX> bool kdtree_get_bbox(BBOX & /* bb */) const { return false; }
 
+        int GetNumCoords() const { return (_nCoords); }
+
     private:
-        std::vector<float> X, Y;
+        std::vector<float> _coords;
+        int                _nCoords;
+
+    };    // end of class PointCloud
 
-    };    // end of class PointCloud2D
+    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, PointCloud>, PointCloud, 2 /* dimension */> KDTreeType2D;
+    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, PointCloud>, PointCloud, 3 /* dimension */> KDTreeType3D;
 
-    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, PointCloud2D>, PointCloud2D, 2 /* dimension */> KDTreeType;
+    PointCloud                    _points;
+    std::unique_ptr<KDTreeType2D> _kdtree2D;
+    std::unique_ptr<KDTreeType3D> _kdtree3D;
+    std::vector<size_t>           _dims;
 
-    PointCloud2D        _points;
-    KDTreeType          _kdtree;
-    std::vector<size_t> _dims;
+    void _nearest(const float *coordu, size_t k, size_t *indices, float *distances) const;
 };    // end of class KDTreeRG.
 
 //! class KDTreeRGSubset
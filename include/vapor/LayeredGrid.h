@@ -105,6 +105,14 @@ public:
     //!
     bool InsideGrid(const CoordType &coords) const override;
 
+    //! \copydoc Grid::LocatePoint()
+    //!
+    void LocatePoint(const CoordType &coords, PointLocation &loc) const override;
+
+    //! \copydoc Grid::GetValueAtLocation()
+    //!
+    float GetValueAtLocation(const PointLocation &loc) const override;
+
     //! \copydoc Grid::GetPeriodic()
     //!
     //! Only horizonal dimensions can be periodic. Layered (third) dimension
@@ -8,6 +8,7 @@
 #define omp_get_num_threads() (1)
 #define omp_set_num_threads(x) (void(x))
 #define omp_get_thread_num() (0)
+#define omp_get_max_threads() (1)
 
 #endif
 
@@ -34,6 +34,11 @@ public:
     //! Load every nth particle. Useful for improving performance
     static const std::string StrideTag;
 
+    //! Upper bound on the number of particles uploaded for rendering. When the
+    //! strided selection exceeds this budget it is thinned uniformly and
+    //! deterministically to exactly this many particles. 0 disables the limit.
+    static const std::string MaxParticlesTag;
+
     //! Scale the rendered particle size
     static const std::string RenderRadiusScalarTag;
     static const std::string RenderRadiusVariableTag;
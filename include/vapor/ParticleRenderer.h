@@ -63,6 +63,7 @@ private:
         bool                direction;
         float               directionScale;
         size_t              stride;
+        long                maxParticles;
         string              varName;
         string              radiusVarName;
         std::vector<std::string> fieldVars;
@@ -94,7 +95,6 @@ private:
     void _resetColormapCache();
     int  _generateParticlesLegacy(Grid*& grid, std::vector<Grid*>& vecGrids);
     int  _getGrids(Grid*& grid, std::vector<Grid*>& vecGrids) const;
-    template<typename T> void UploadDataBuffer(vector<T> buffer);
     void _generateTextureData(const Grid* grid, const std::vector<Grid*>& vecGrids);
     void _computeBaseRadius();
     void _renderParticlesLegacy(const Grid* grid, const std::vector<Grid*>& vecGrids) const;
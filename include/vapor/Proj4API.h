@@ -14,6 +14,10 @@ namespace VAPoR {
 //! This class provides a convience wrapper for the proj4 Cartographic
 //! Projections Library http://trac.osgeo.org/proj/
 //!
+//! Each object has its own proj4 context, which holds its error state.
+//! Hence different objects may be used concurrently from different threads,
+//! while a single object may not.
+//!
 class VDF_API Proj4API : public Wasp::MyBase {
 public:
     Proj4API();
@@ -31,7 +35,7 @@ public:
     //!
     //! \retval status Retruns a negative int on failure
     //!
-    //! \sa pj_init_plus()
+    //! \sa pj_init_plus_ctx()
     //
     int Initialize(string srcdef, string dstdef);
 
@@ -101,9 +105,9 @@ public:
     int Transform(string srcdef, string dstdef, float *x, float *y, float *z, size_t n, int offset) const;
 
     //! Return the error string generated by the proj4 C API for the
-    //! most recent error
+    //! most recent error of this object
     //!
-    //! \sa pj_strerrno()
+    //! \sa pj_strerrno(), pj_ctx_get_errno()
 
     string ProjErr() const;
 
@@ -121,6 +125,7 @@ public:
     bool IsCylindrical() const;
 
 private:
+    void *_pjCtx;
     void *_pjSrc;
     void *_pjDst;
 
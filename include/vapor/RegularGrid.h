@@ -74,6 +74,10 @@ public:
     //
     virtual bool InsideGrid(const CoordType &coords) const override;
 
+    //! \copydoc Grid::LocatePoint()
+    //
+    virtual void LocatePoint(const CoordType &coords, PointLocation &loc) const override;
+
     class ConstCoordItrRG : public Grid::ConstCoordItrAbstract {
     public:
         ConstCoordItrRG(const RegularGrid *rg, bool begin);
@@ -74,6 +74,7 @@ private:
 
     bool   _initialized;
     size_t _textureSideSize;
+    bool   _textureIsCoarse;    // texture was generated at reduced resolution in fast mode
 
     GLuint _colorMapTextureID;
     GLuint _dataValueTextureID;
@@ -25,6 +25,9 @@ namespace VAPoR {
 //! while the remaining x and y coordinates are givey by (i*dx, j*dy)
 //! for some real dx and dy .
 //!
+//! \note This class is not currently implemented or built. See
+//! lib/vdc/TODO.txt
+//!
 //
 class VDF_API SphericalGrid : public RegularGrid {
 public:
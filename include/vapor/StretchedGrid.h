@@ -93,6 +93,10 @@ public:
     //
     virtual bool InsideGrid(const CoordType &coords) const override;
 
+    //! \copydoc Grid::LocatePoint()
+    //
+    virtual void LocatePoint(const CoordType &coords, PointLocation &loc) const override;
+
     //! Returns reference to vector containing X user coordinates
     //!
     //! Returns reference to vector passed to constructor
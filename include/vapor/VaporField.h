@@ -7,6 +7,8 @@
 #include "vapor/FlowParams.h"
 #include "vapor/Grid.h"
 #include "vapor/ptr_cache.hpp"
+#include <future>
+#include <memory>
 
 namespace flow {
 
@@ -66,6 +68,9 @@ public:
     virtual bool InsideVolumeVelocity(double time, glm::vec3 pos) const override;
     virtual bool InsideVolumeScalar(double time, glm::vec3 pos) const override;
     virtual uint32_t  GetNumberOfTimesteps() const override;
+    virtual std::vector<double> GetTimestamps() const override;
+    virtual int PrepareTimeWindow(double t0, double t1, bool prefetchNext = false) const override;
+    virtual void FinishTimeWindows() const override;
 
     virtual int GetVelocity(double time, glm::vec3 pos,     // input
                             glm::vec3 &vel) const override; // output
@@ -78,6 +83,7 @@ public:
     void AssignDataManager(VAPoR::DataMgr *dmgr);
     void UpdateParams(const VAPoR::FlowParams *);
     void ReleaseLockedGrids();    // Supposed to be invoked at the end of each paintGL event.
+                                  // It also releases the grids pinned by PrepareTimeWindow().
 
     //
     // Find one index whose timestamp is just below a given time
@@ -120,6 +126,30 @@ private:
     mutable cacheType _recentGrids;
     mutable std::mutex _grid_operation_mutex;
 
+    // Everything needed to retrieve a grid, with params read at the time of the request,
+    // so the grid can also be loaded by a thread other than the one that asked for it.
+    struct GridRequest {
+        uint32_t         timestep;
+        std::string      varName;
+        int32_t          refLev;
+        int32_t          compLev;
+        VAPoR::CoordType extMin;
+        VAPoR::CoordType extMax;
+        GridKey          key() const;
+    };
+
+    // For unsteady fields, PrepareTimeWindow() pins the grids of the time steps of
+    // the current bracket, and, if asked to, starts loading those of the next time
+    // step in the background. Pinned grids are not subject to the LRU policy of _recentGrids,
+    // and they are looked up without locking. Hence _pinnedGrids only changes in
+    // functions that don't run concurrently with queries.
+    struct PinnedGrid {
+        GridKey                      key;
+        uint32_t                     timestep;
+        std::unique_ptr<GridWrapper> wrapper;
+    };
+    mutable std::vector<PinnedGrid> _pinnedGrids;
+
     // The following variables are cache states from DataMgr and Params.
     bool                               _params_locked = false;
     uint32_t                           _c_currentTS = 0;          // cached timestep
@@ -128,6 +158,16 @@ private:
     float                              _c_vel_mult = 0.0f;        // cached velocity multiplier
     VAPoR::CoordType                   _c_ext_min;                // cached extents
     VAPoR::CoordType                   _c_ext_max;                // cached extents
+    bool                               _c_vel_shared_coords = false; // velocity components share coordinates
+
+    // Grids being loaded in the background, and the error that stopped the loading,
+    // if any. Declared last, so that it's destroyed, which waits for the loading
+    // to finish, before anything the loading uses.
+    struct Prefetched {
+        std::vector<PinnedGrid> grids;
+        std::string             error;
+    };
+    mutable std::future<Prefetched> _prefetch;
 
     //
     // Member functions
@@ -141,6 +181,26 @@ private:
     // This failure will also be recorded to MyBase.
     // Note: If a variable name is empty, we then return a ConstantField.
     const VAPoR::Grid *_getAGrid(uint32_t timestep, const std::string &varName) const;
+
+    // Gather the params that identify a grid, and load a grid according to them.
+    // The caller of _loadGrid() must hold _grid_operation_mutex. On failure, the first
+    // version reports the error, and the second one only returns it.
+    GridRequest  _makeRequest(uint32_t timestep, const std::string &varName) const;
+    VAPoR::Grid *_loadGrid(const GridRequest &) const;
+    VAPoR::Grid *_loadGrid(const GridRequest &, std::string &error) const;
+
+    // Wait for the grids loading in the background, and pin them.
+    // Reports the error that stopped the loading, if any, and returns GRID_ERROR.
+    int _finishPrefetch() const;
+    // Unpin all grids, or the ones of time steps outside of [first, last].
+    void _releasePinnedGrids() const;
+    void _releasePinnedGrids(size_t first, size_t last) const;
+
+    // Sample the three velocity components at a given time step. When the component
+    // grids share coordinates the point is located only once for all three of them.
+    // Missing values of the three grids are returned in missingV.
+    int _getVelocityAtTimestep(uint32_t timestep, const VAPoR::CoordType &coords, // input
+                               glm::vec3 &velocity, glm::vec3 &missingV) const;   // output
 };
 };    // namespace flow
 
@@ -16,6 +16,7 @@ class VolumeParams;
 class ViewpointParams;
 class AnnotationParams;
 class Transform;
+class DataMgr;
 
 //! \class VolumeAlgorithm
 //! \ingroup Public_Render
@@ -59,6 +60,7 @@ protected:
     ViewpointParams * GetViewpointParams() const;
     AnnotationParams *GetAnnotationParams() const;
     Transform *       GetDatasetTransform() const;
+    DataMgr *         GetDataMgr() const;
     void              GetExtents(glm::vec3 *dataMin, glm::vec3 *dataMax, glm::vec3 *userMin, glm::vec3 *userMax) const;
 
 private:
@@ -55,8 +55,24 @@ private:
     bool _useHighPrecisionTriangleRoutine;
     bool _gridHasInvertedCoordinateSystemHandiness;
 
+    //! Identifies the coordinates the textures above were built from so
+    //! that reloading a grid with the same geometry (e.g. a different
+    //! variable on the same mesh) skips the coordinate and BB tree rebuild
+    struct {
+        bool                     valid = false;
+        std::vector<std::string> coordVars;
+        size_t                   ts;
+        int                      refLevel;
+        int                      lod;
+        DimsType                 dims;
+        DimsType                 minAbs;
+    } _geometryCache;
+
     bool        _needsHighPrecisionTriangleRoutine(const Grid *grid);
     static bool _need32BitForCoordinates(const Grid *grid);
+    bool        _isGeometryCacheDirty(const Grid *grid) const;
+    void        _saveGeometryCache(const Grid *grid);
+    int         _loadGeometry(const Grid *grid);
 
 protected:
     int                 _getHeuristicBBLevels() const;
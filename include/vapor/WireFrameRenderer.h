@@ -11,6 +11,7 @@
 
 #include <vapor/glutil.h>    // Must be included first!!!
 #include <utility>
+#include <cstdint>
 #include <vapor/DataMgr.h>
 #include <vapor/utils.h>
 #include <vapor/Renderer.h>
@@ -62,45 +63,16 @@ private:
 
     } _cacheParams;
 
-    // Helper class to keep track of which cell edges have been drawn so
-    // we can avoid duplicate draws.
+    // Identifies the mesh topology that the cached connectivity (the
+    // element buffer) was generated for
     //
-    class DrawList {
-    public:
-        // maxEntries is the maximum number of unique cell nodes.
-        // maxLinesPerVertex is the *expected* max valence (degree) of any
-        // node (vertex). If a node has more than maxLinesPerVertex edges
-        // only the first maxLinesPerVertex edges will be recorded in
-        // DrawList. Hence, queries to edges with DrawList::InList will
-        // return false once maxLinesPerVertex has been exceeded
-        //
-        DrawList(GLuint maxEntries, size_t maxLinesPerVertex)
-        : _drawList(maxEntries * maxLinesPerVertex, (std::numeric_limits<GLuint>::max)()), _maxEntries(maxEntries), _maxLinesPerVertex(maxLinesPerVertex)
-        {
-        }
-
-        bool InList(GLuint idx0, GLuint idx1)
-        {
-            VAssert(idx0 < _maxEntries);
-            VAssert(idx1 < _maxEntries);
-
-            if (idx1 < idx0) { std::swap(idx1, idx0); }
-
-            for (int i = 0; i < _maxLinesPerVertex; i++) {
-                if (_drawList[idx0 * _maxLinesPerVertex + i] == idx1) { return (true); }
-                if (_drawList[idx0 * _maxLinesPerVertex + i] == (std::numeric_limits<GLuint>::max)()) {
-                    _drawList[idx0 * _maxLinesPerVertex + i] = idx1;
-                    return (false);
-                }
-            }
-            return (false);
-        }
-
-    private:
-        vector<GLuint> _drawList;
-        const size_t   _maxEntries;
-        const size_t   _maxLinesPerVertex;
-    };
+    struct {
+        bool     valid;
+        string   meshName;
+        string   gridType;
+        DimsType dims;
+        DimsType minAbs;
+    } _topologyCache;
 
     void _buildCacheVertices(const Grid *grid, const Grid *heightGrid, vector<GLuint> &nodeMap, bool *GPUOutOfMemory) const;
 
@@ -109,7 +81,9 @@ private:
     int  _buildCache();
     bool _isCacheDirty() const;
     void _saveCacheParams();
-    void _drawCell(const GLuint *cellNodeIndices, int n, bool layered, const std::vector<GLuint> &nodeMap, GLuint invalidIndex, std::vector<unsigned int> &indices, DrawList &drawList) const;
+    bool _isTopologyCacheDirty(const Grid *grid) const;
+    void _saveTopologyCacheParams(const Grid *grid);
+    void _cellEdges(const GLuint *cellNodeIndices, int n, bool layered, const std::vector<GLuint> &nodeMap, GLuint invalidIndex, std::vector<uint64_t> &edges) const;
 
     void _clearCache() { _cacheParams.varName.clear(); }
 };
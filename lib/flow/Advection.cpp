@@ -2,11 +2,91 @@
 #include "vapor/Advection.h"
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <limits>
 
 using namespace flow;
 
+namespace {
+// The largest eigenvalue of a symmetric 3x3 matrix, from the closed-form solution
+// of its characteristic polynomial.
+double MaxSymmetricEigenvalue(const double m[3][3])
+{
+    const double p1 = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+    const double q = (m[0][0] + m[1][1] + m[2][2]) / 3.0;
+    if (p1 == 0.0) return std::max(m[0][0], std::max(m[1][1], m[2][2]));    // diagonal
+
+    const double p2 = (m[0][0] - q) * (m[0][0] - q) + (m[1][1] - q) * (m[1][1] - q) + (m[2][2] - q) * (m[2][2] - q) + 2.0 * p1;
+    const double p = std::sqrt(p2 / 6.0);
+    double       b[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) b[i][j] = (m[i][j] - (i == j ? q : 0.0)) / p;
+    const double det = b[0][0] * (b[1][1] * b[2][2] - b[1][2] * b[2][1]) - b[0][1] * (b[1][0] * b[2][2] - b[1][2] * b[2][0]) + b[0][2] * (b[1][0] * b[2][1] - b[1][1] * b[2][0]);
+    const double r = glm::clamp(det / 2.0, -1.0, 1.0);
+    return q + 2.0 * p * std::cos(std::acos(r) / 3.0);
+}
+
+// The FTLE at every node of a structured lattice of "dims" nodes, from the flow map
+// that takes each node's seed to its end location. The flow map is differentiated
+// along each lattice axis, with central differences inside and one-sided differences
+// on the boundary, and then with respect to space through the inverse Jacobian of the
+// seed locations, so the lattice need not be uniform or axis-aligned. Along an axis
+// of length 1 the lattice is taken to extend along the matching coordinate axis.
+// The FTLE follows from the largest eigenvalue of the Cauchy-Green deformation tensor.
+// Nodes whose seed, or whose neighbors' seeds, are not valid receive +inf.
+void FlowMapToFTLE(const VAPoR::DimsType &dims, const std::vector<glm::vec3> &seeds, const std::vector<glm::vec3> &ends, const std::vector<char> &valid, double duration,
+                   std::vector<float> &values)
+{
+    const size_t nx = dims[0], ny = dims[1], nz = dims[2];
+    const size_t n = nx * ny * nz;
+    const size_t strides[3] = {1, nx, nx * ny};
+    values.assign(n, std::numeric_limits<float>::infinity());
+
+    #pragma omp parallel for schedule(static)
+    for (long l = 0; l < (long)n; l++) {
+        const size_t idx[3] = {size_t(l) % nx, (size_t(l) / nx) % ny, size_t(l) / (nx * ny)};
+
+        // Columns are derivatives along each lattice axis: of the flow map in F, and of
+        // the seed locations in X.
+        glm::dvec3 F[3], X[3];
+        bool       ok = valid[l];
+        for (int a = 0; a < 3 && ok; a++) {
+            if (dims[a] == 1) {
+                F[a] = glm::dvec3(0.0);
+                X[a] = glm::dvec3(0.0);
+                X[a][a] = 1.0;
+                continue;
+            }
+            size_t lo = idx[a] > 0 ? l - strides[a] : l;
+            size_t hi = idx[a] + 1 < dims[a] ? l + strides[a] : l;
+            ok = valid[lo] && valid[hi];
+            F[a] = glm::dvec3(ends[hi] - ends[lo]);
+            X[a] = glm::dvec3(seeds[hi] - seeds[lo]);
+        }
+        if (!ok) continue;
+
+        // The rows of the inverse of X are the cross products of its columns over its determinant
+        const double det = glm::dot(X[0], glm::cross(X[1], X[2]));
+        if (det == 0.0) continue;
+        const glm::dvec3 inv[3] = {glm::cross(X[1], X[2]) / det, glm::cross(X[2], X[0]) / det, glm::cross(X[0], X[1]) / det};
+
+        // The spatial gradient of the flow map, column by column
+        glm::dvec3 gradient[3];
+        for (int a = 0; a < 3; a++) gradient[a] = F[0] * inv[0][a] + F[1] * inv[1][a] + F[2] * inv[2][a];
+
+        double cauchyGreen[3][3];
+        for (int a = 0; a < 3; a++)
+            for (int b = 0; b < 3; b++) cauchyGreen[a][b] = glm::dot(gradient[a], gradient[b]);
+
+        const double lambda = MaxSymmetricEigenvalue(cauchyGreen);
+        if (lambda > 0.0) values[l] = float(0.5 * std::log(lambda) / duration);
+    }
+}
+}    // namespace
+
 // Constructor;
-Advection::Advection() : _lowerAngle(3.0f), _upperAngle(15.0f)
+Advection::Advection() : _lowerAngle(3.0f), _upperAngle(15.0f), _rk45RelTol(1e-5), _rk45AbsTol(0.0)
 {
     _lowerAngleCos = glm::cos(glm::radians(_lowerAngle));
     _upperAngleCos = glm::cos(glm::radians(_upperAngle));
@@ -23,6 +103,14 @@ void Advection::UseSeedParticles(const std::vector<Particle> &seeds)
       _streams[i].push_back(seeds[i]);
 
     _separatorCount.assign(seeds.size(), 0);
+    _hasValueRange = false;
+    _rk45States.assign(seeds.size(), RK45State());
+}
+
+void Advection::SetRK45Tolerance(double relTol, double absTol)
+{
+    _rk45RelTol = relTol;
+    _rk45AbsTol = absTol;
 }
 
 int Advection::CheckReady() const
@@ -45,138 +133,16 @@ int Advection::AdvectSteps(Field *velocity, double deltaT, size_t maxSteps, bool
     if (velocity->LockParams() != 0) 
       return PARAMS_ERROR;
 
+    _rk45States.resize(_streams.size());
+    _hasValueRange = false;
+
     // The particle advection process can be parallelized per particle
     // Each stream represents a trajectory for a single particle
-    #pragma omp parallel for
-    for (size_t streamIdx = 0; streamIdx < _streams.size(); streamIdx++) {
-        auto& s = _streams[streamIdx];
-        size_t numberOfSteps = s.size() - _separatorCount[streamIdx];
-        while (numberOfSteps < maxSteps) {
-            auto &past0 = s.back();
-            if (past0.IsSpecial())    // If the last particle is marked "special,"
-                break;                // terminate stream immediately.
-
-            double dt = deltaT;
-            if (!fixedStepSize && s.size() > 2)   // When not using fixed step sizes and there are at least 3 particles in the stream,
-            {                                     // none is a separator, we adjust *dt*.
-                const auto &past1 = s[s.size() - 2];
-                const auto &past2 = s[s.size() - 3];
-                if ((!past1.IsSpecial()) && (!past2.IsSpecial())) {
-                    // We enforce a factor of 20.0f as a limit of how much the step size
-                    // can be adjusted by _calcAdjustFactor().
-                    // I.e., the adjusted value can be at most 20X larger or 20X smaller.
-                    // The choice of 20.0f is just an empirical value that seems to work well.
-                    double mindt = deltaT / 20.0, maxdt = deltaT * 20.0;
-                    dt = past0.time - past1.time;    // step size used by last integration
-                    dt *= _calcAdjustFactor(past2, past1, past0);
-                    if (dt > 0)    // integrate forward
-                        dt = glm::clamp(dt, mindt, maxdt);
-                    else    // integrate backward
-                        dt = glm::clamp(dt, maxdt, mindt);
-                }
-            }
-
-            Particle p1;
-            int      rv = 0;
-            switch (method) {
-            case ADVECTION_METHOD::EULER:
-                rv = _advectEuler(velocity, past0, dt, p1);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
-                break;
-            case ADVECTION_METHOD::RK4:
-                rv = _advectRK4(velocity, past0, dt, p1);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
-                break;
-            }
-
-            if (rv == SUCCESS) {
-                // Bookmark_1
-                // The new particle *may* be the same as the old particle in case
-                // there's a sink, meaning the velocity is zero.
-                // In that case, we mark p1 as "special" and terminate the current stream.
-                if (p1.location == past0.location) {
-                    p1.SetSpecial(true);
-                    s.emplace_back(p1);
-                    _separatorCount[streamIdx]++;
-                    break;
-                } else {
-                    happened = true;
-                    s.emplace_back(p1);
-                    numberOfSteps++;
-                }
-            } else if (rv == MISSING_VAL) {
-                // Bookmark_2
-                // This is the annoying part: there are multiple possiblities.
-                // 1) past0 is really located at a missing value location;
-                // 2) past0 is inside the volume, but really close to the boundary,
-                //    causing RK4 method to fail;
-                // 3) past0 is not at a missing location, but out of the volume.
-                //
-                // Note that we need to detect and deal with each of these possibilities
-                //   here instead of using the periodic capabilities of a grid class,
-                //   because the advection code needs to have knowledge when a pathline
-                //   exits from one side and comes back from another sice, and record
-                //   this event by inserting a separator. The separator will later be used
-                //   by the rendering code to break a pathline into segments.
-
-                glm::vec3 vel;
-                bool isMissing = (velocity->GetVelocity(past0.time, past0.location, vel) == MISSING_VAL);
-                bool isInside = velocity->InsideVolumeVelocity(past0.time, past0.location);
-
-                if (isInside && isMissing) {    // Case 1)
-                    // We identified a particle at a bad location.
-                    // We mark it as special, and terminate the current stream.
-                    past0.SetSpecial(true);
-                    _separatorCount[streamIdx]++;
-                    break;
-                } else if (isInside && (!isMissing)) {    // Case 2)
-                    // Use Euler advection for this particle.
-                    rv = _advectEuler(velocity, past0, dt, p1);
-                    assert(rv == 0);
-                    s.emplace_back(p1);
-                    numberOfSteps++;
-                } else {    // Case 3)
-                    // We identified a particle that's out of the volume.
-                    // We treat it depending on field periodicity.
-                    // In case of no periodicity, we mark this particle special and
-                    //    terminate the current stream.
-                    // In case of periodicity enabled, we apply it!
-                    if ((!_isPeriodic[0]) && (!_isPeriodic[1]) && (!_isPeriodic[2])) {
-                        past0.SetSpecial(true);
-                        _separatorCount[streamIdx]++;
-                        break;
-                    } else {
-                        auto loc = past0.location;
-                        for (int i = 0; i < 3; i++) {
-                            if (_isPeriodic[i]) 
-                              loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
-                        }
-
-                        // Notice that loc isn't guaranteed to be inside the volume right now,
-                        // since periodic ain't enabled for all directions.
-                        // As a result, we need to test again
-                        if (velocity->InsideVolumeVelocity(past0.time, loc)) {
-                            past0.location = loc;
-                            Particle separator;
-                            separator.SetSpecial(true);
-                            auto it = s.end();
-                            --it;
-                            s.insert(it, separator);
-                            _separatorCount[streamIdx]++;
-                        } else {
-                            past0.SetSpecial(true);
-                            _separatorCount[streamIdx]++;
-                            break;
-                        }
-                    }
-                }
-
-            }       // end (rv == MISSING_VAL) condition
-            else    // Advection wasn't successful for other reasons
-                break;
-
-        }    // end loop for particle
-    }        // end loop for streams
+    #pragma omp parallel for schedule(dynamic, 16) reduction(||: happened)
+    for (long streamIdx = 0; streamIdx < (long)_streams.size(); streamIdx++) {
+        bool streamHappened = _advectStreamSteps(velocity, streamIdx, deltaT, maxSteps, fixedStepSize, method);
+        happened = happened || streamHappened;
+    }
 
     velocity->UnlockParams();
 
@@ -186,163 +152,257 @@ int Advection::AdvectSteps(Field *velocity, double deltaT, size_t maxSteps, bool
         return NO_ADVECT_HAPPENED;
 }
 
-int Advection::AdvectTillTime(Field *velocity, double startT, double deltaT, double targetT, bool fixedStepSize, ADVECTION_METHOD method)
+int Advection::AdvectSteps(Field *velocity, double deltaT, size_t maxSteps, bool fixedStepSize, Advection &other, double otherDeltaT, ADVECTION_METHOD method)
 {
     int ready = CheckReady();
     if (ready != 0) return ready;
+    ready = other.CheckReady();
+    if (ready != 0) return ready;
+    bool happened = false;
 
-    bool   happened = false;
-    size_t streamIdx = 0;
-    size_t maxSteps = 10000;
-    for (auto &s : _streams)    // Process one stream at a time
-    {
-        Particle p0 = s.back();    // Start from the last particle in this stream
-        if (p0.time < startT)      // Skip this stream if it didn't advance to startT
-            continue;
-
-        if (p0.IsSpecial())       // Also skip this tream if it was marked special.
-            continue;
-
-        size_t thisStep = 0;
-
-        while (p0.time < targetT) {
+    if (velocity->LockParams() != 0) 
+      return PARAMS_ERROR;
 
-            // Check if the particle is inside of the volume.
-            // Wrap it along periodic dimensions if applicable.
-            if (!velocity->InsideVolumeVelocity(p0.time, p0.location)) {
-                bool locChanged = false;
-                auto itr = s.end();
-                --itr;    // pointing to the last element
-                auto loc = itr->location;
-                for (int i = 0; i < 3; i++) {
-                    if (_isPeriodic[i]) {
-                        loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
-                        locChanged = true;
-                    }
-                }
-                if (!locChanged) {  // no dimension is periodic, append a separator
-                    Particle separator;
-                    separator.SetSpecial(true);
-                    s.push_back(separator);
-                    _separatorCount[streamIdx]++;
-                    break;          // break the while loop
-                }
+    _rk45States.resize(_streams.size());
+    other._rk45States.resize(other._streams.size());
+    _hasValueRange = false;
+    other._hasValueRange = false;
+
+    // One parallel loop over the streams of both objects, so that the work of
+    // both fills the threads together.
+    const long nStreams = _streams.size();
+    const long nTotal = nStreams + other._streams.size();
+    #pragma omp parallel for schedule(dynamic, 16) reduction(||: happened)
+    for (long i = 0; i < nTotal; i++) {
+        bool streamHappened;
+        if (i < nStreams)
+            streamHappened = _advectStreamSteps(velocity, i, deltaT, maxSteps, fixedStepSize, method);
+        else
+            streamHappened = other._advectStreamSteps(velocity, i - nStreams, otherDeltaT, maxSteps, fixedStepSize, method);
+        happened = happened || streamHappened;
+    }
 
-                // See if the new location is inside of the volume
-                if (velocity->InsideVolumeVelocity(itr->time, loc)) {
-                    itr->location = loc;
-                    p0 = *itr;    // p0 is equal to the wrapped particle
+    velocity->UnlockParams();
 
-                    Particle separator;
-                    separator.SetSpecial(true);
-                    s.insert(itr, separator);
-                    _separatorCount[streamIdx]++;
-                } else {  // Still outside, so we terminate the stream!
-                    Particle separator;
-                    separator.SetSpecial(true);
-                    s.push_back(separator);
-                    _separatorCount[streamIdx]++;
-                    break;    // break the while loop
-                }
-            } // Finish the out-of-volume condition
+    if (happened)
+        return SUCCESS;
+    else
+        return NO_ADVECT_HAPPENED;
+}
 
-            double dt = deltaT;
-            if (!fixedStepSize && s.size() > 2)
-            {
+bool Advection::_advectStreamSteps(Field *velocity, size_t streamIdx, double deltaT, size_t maxSteps, bool fixedStepSize, ADVECTION_METHOD method)
+{
+    bool happened = false;
+    auto& s = _streams[streamIdx];
+    size_t numberOfSteps = s.size() - _separatorCount[streamIdx];
+    while (numberOfSteps < maxSteps) {
+        auto &past0 = s.back();
+        if (past0.IsSpecial())    // If the last particle is marked "special,"
+            break;                // terminate stream immediately.
+
+        double dt = deltaT;
+        if (method == ADVECTION_METHOD::RK45) {
+            // RK45 takes the step size suggested by its error control, within the same limits.
+            double next = _rk45States[streamIdx].nextDt;
+            if (!fixedStepSize && next * deltaT > 0.0) {
+                double mindt = deltaT / 20.0, maxdt = deltaT * 20.0;
+                dt = (dt > 0) ? glm::clamp(next, mindt, maxdt) : glm::clamp(next, maxdt, mindt);
+            }
+        }
+        else if (!fixedStepSize && s.size() > 2)   // When not using fixed step sizes and there are at least 3 particles in the stream,
+        {                                          // none is a separator, we adjust *dt*.
+            const auto &past1 = s[s.size() - 2];
+            const auto &past2 = s[s.size() - 3];
+            if ((!past1.IsSpecial()) && (!past2.IsSpecial())) {
+                // We enforce a factor of 20.0f as a limit of how much the step size
+                // can be adjusted by _calcAdjustFactor().
+                // I.e., the adjusted value can be at most 20X larger or 20X smaller.
+                // The choice of 20.0f is just an empirical value that seems to work well.
                 double mindt = deltaT / 20.0, maxdt = deltaT * 20.0;
-                maxdt = glm::min(maxdt, targetT - p0.time);
-                const auto &past1 = s[s.size() - 2];
-                const auto &past2 = s[s.size() - 3];
-                if ((!past1.IsSpecial()) && (!past2.IsSpecial())) {
-                    dt = p0.time - past1.time;    // step size used by last integration
-                    dt *= _calcAdjustFactor(past2, past1, p0);
+                dt = past0.time - past1.time;    // step size used by last integration
+                dt *= _calcAdjustFactor(past2, past1, past0);
+                if (dt > 0)    // integrate forward
                     dt = glm::clamp(dt, mindt, maxdt);
-                }
+                else    // integrate backward
+                    dt = glm::clamp(dt, maxdt, mindt);
             }
+        }
 
-            Particle p1;
-            int      rv = 0;
-            switch (method) {
-            case ADVECTION_METHOD::EULER:
-                rv = _advectEuler(velocity, p0, dt, p1);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
-                break;
-            case ADVECTION_METHOD::RK4:
-                rv = _advectRK4(velocity, p0, dt, p1);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
+        Particle p1;
+        int      rv = 0;
+        switch (method) {
+        case ADVECTION_METHOD::EULER:
+            rv = _advectEuler(velocity, past0, dt, p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            break;
+        case ADVECTION_METHOD::RK4:
+            rv = _advectRK4(velocity, past0, dt, p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            break;
+        case ADVECTION_METHOD::RK45:
+            rv = _advectRK45(velocity, past0, dt, fixedStepSize ? dt : deltaT / 20.0, fixedStepSize, _rk45States[streamIdx], p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            break;
+        }
+
+        if (rv == SUCCESS) {
+            // Bookmark_1
+            // The new particle *may* be the same as the old particle in case
+            // there's a sink, meaning the velocity is zero.
+            // In that case, we mark p1 as "special" and terminate the current stream.
+            if (p1.location == past0.location) {
+                p1.SetSpecial(true);
+                s.emplace_back(p1);
+                _separatorCount[streamIdx]++;
                 break;
+            } else {
+                happened = true;
+                s.emplace_back(p1);
+                numberOfSteps++;
             }
-
-            if (rv == SUCCESS) {
-                // Check out Bookmark_1
-                if (p1.location == p0.location) {
-                    p1.SetSpecial(true);
-                    s.push_back(p1);
-                    _separatorCount[streamIdx]++;
-                    break;
-                } else {
-                    happened = true;
-                    s.push_back(p1);
-                    p0 = p1;
-                }
-            } else if (rv == MISSING_VAL) {
-                // Check out Bookmark_2
-                glm::vec3 vel;
-                bool isMissing = (velocity->GetVelocity(p0.time, p0.location, vel) == MISSING_VAL);
-                bool isInside = velocity->InsideVolumeVelocity(p0.time, p0.location);
-
-                if (isInside && isMissing) {
-                    p1.SetSpecial(true);
-                    s.push_back(p1);
+        } else if (rv == MISSING_VAL) {
+            // Bookmark_2
+            // This is the annoying part: there are multiple possiblities.
+            // 1) past0 is really located at a missing value location;
+            // 2) past0 is inside the volume, but really close to the boundary,
+            //    causing RK4 method to fail;
+            // 3) past0 is not at a missing location, but out of the volume.
+            //
+            // Note that we need to detect and deal with each of these possibilities
+            //   here instead of using the periodic capabilities of a grid class,
+            //   because the advection code needs to have knowledge when a pathline
+            //   exits from one side and comes back from another sice, and record
+            //   this event by inserting a separator. The separator will later be used
+            //   by the rendering code to break a pathline into segments.
+
+            glm::vec3 vel;
+            bool isMissing = (velocity->GetVelocity(past0.time, past0.location, vel) == MISSING_VAL);
+            bool isInside = velocity->InsideVolumeVelocity(past0.time, past0.location);
+
+            if (isInside && isMissing) {    // Case 1)
+                // We identified a particle at a bad location.
+                // We mark it as special, and terminate the current stream.
+                past0.SetSpecial(true);
+                _separatorCount[streamIdx]++;
+                break;
+            } else if (isInside && (!isMissing)) {    // Case 2)
+                // Use Euler advection for this particle.
+                rv = _advectEuler(velocity, past0, dt, p1);
+                assert(rv == 0);
+                s.emplace_back(p1);
+                numberOfSteps++;
+            } else {    // Case 3)
+                // We identified a particle that's out of the volume.
+                // We treat it depending on field periodicity.
+                // In case of no periodicity, we mark this particle special and
+                //    terminate the current stream.
+                // In case of periodicity enabled, we apply it!
+                if ((!_isPeriodic[0]) && (!_isPeriodic[1]) && (!_isPeriodic[2])) {
+                    past0.SetSpecial(true);
                     _separatorCount[streamIdx]++;
                     break;
-                } else if (isInside && (!isMissing)) {
-                    rv = _advectEuler(velocity, p0, dt, p1);
-                    assert(rv == 0);
-                    s.push_back(p1);
-                    p0 = p1;
                 } else {
-                    auto loc = p0.location;
+                    auto loc = past0.location;
                     for (int i = 0; i < 3; i++) {
-                        if (_isPeriodic[i])
-                            loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
+                        if (_isPeriodic[i]) 
+                          loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
                     }
 
-                    if (velocity->InsideVolumeVelocity(p0.time, loc)) {
-                        p1.SetSpecial(true);
+                    // Notice that loc isn't guaranteed to be inside the volume right now,
+                    // since periodic ain't enabled for all directions.
+                    // As a result, we need to test again
+                    if (velocity->InsideVolumeVelocity(past0.time, loc)) {
+                        past0.location = loc;
+                        Particle separator;
+                        separator.SetSpecial(true);
                         auto it = s.end();
                         --it;
-                        s.insert(it, p1);
-                        it = s.end();
-                        --it;
-                        it->location = loc;
+                        s.insert(it, separator);
                         _separatorCount[streamIdx]++;
                     } else {
-                        p1.SetSpecial(true);
-                        s.push_back(p1);
+                        past0.SetSpecial(true);
                         _separatorCount[streamIdx]++;
                         break;
                     }
                 }
-            } // finish handling missing value
-
-            // Another termination criterion: when advecting at least 10,000 steps and
-            // more than 10X more than the previous max num of steps.
-            //
-            if (++thisStep == maxSteps) {
-                thisStep = maxSteps / 10;
-                p1.SetSpecial(true);
-                s.push_back(p1);
-                _separatorCount[streamIdx]++;
-                break;
             }
-        }    // Finish advecting one particle
 
-        maxSteps = std::max(maxSteps, thisStep * 10);
+        }       // end (rv == MISSING_VAL) condition
+        else    // Advection wasn't successful for other reasons
+            break;
+
+    }    // end loop for particle
+
+    return happened;
+}
+
+int Advection::AdvectTillTime(Field *velocity, double startT, double deltaT, double targetT, bool fixedStepSize, ADVECTION_METHOD method)
+{
+    int ready = CheckReady();
+    if (ready != 0) return ready;
+
+    // Only streams that have already passed startT, and were not terminated,
+    // take part in this advection.
+    std::vector<char> active(_streams.size(), 0);
+    for (size_t i = 0; i < _streams.size(); i++) {
+        const auto &p0 = _streams[i].back();
+        active[i] = (p0.time >= startT) && (!p0.IsSpecial());
+    }
+
+    // Time-window scheduling: the time span is split at the time stamps of the field,
+    // and all streams advance through one window, which lies within one pair of
+    // bracketing time steps, before any stream moves on to the next. This keeps the
+    // velocity grids in use limited to those of a single bracket.
+    std::vector<double> windowEnds;
+    for (double t : velocity->GetTimestamps()) {
+        if (t > startT && t < targetT) windowEnds.push_back(t);
+    }
+    windowEnds.push_back(targetT);
+
+    _rk45States.resize(_streams.size());
+    _hasValueRange = false;
+
+    bool   happened = false;
+    double windowStart = startT;
+    size_t maxSteps = 10000;
+    for (double windowEnd : windowEnds) {
+        // Streams that already made it past this window, e.g. when the same
+        // interval is advected again, need nothing from it: skip loading it.
+        bool behind = false;
+        for (size_t i = 0; i < _streams.size() && !behind; i++) behind = active[i] && _streams[i].back().time < windowEnd;
+        if (!behind) {
+            windowStart = windowEnd;
+            continue;
+        }
 
-        streamIdx++;
+        // Load everything the field needs for this window before querying it
+        // from multiple threads, and get the next window loading, if there is one.
+        velocity->PrepareTimeWindow(windowStart, windowEnd, windowEnd != windowEnds.back());
+
+        // Another termination criterion: when a stream advects at least 10,000 steps
+        // within one window, and more than 10X more than the maximum number of steps
+        // any stream took in the previous windows.
+        // Step counts are gathered per stream and reduced after the parallel loop,
+        // so the result does not depend on the number of threads.
+        std::vector<size_t> steps(_streams.size(), 0);
+        bool                windowHappened = false;
+
+        #pragma omp parallel for schedule(dynamic, 16) reduction(||: windowHappened)
+        for (long streamIdx = 0; streamIdx < (long)_streams.size(); streamIdx++) {
+            if (!active[streamIdx]) continue;
+            bool streamHappened = false;
+            bool hitLimit = false;
+            bool done = _advectStreamTillTime(velocity, streamIdx, deltaT, windowEnd, fixedStepSize, method, maxSteps, steps[streamIdx], streamHappened, hitLimit);
+            if (done) active[streamIdx] = 0;
+            if (hitLimit) steps[streamIdx] = maxSteps / 10;
+            windowHappened = windowHappened || streamHappened;
+        }
 
-    }    // Finish advecting all particles
+        happened = happened || windowHappened;
+        for (size_t n : steps) maxSteps = std::max(maxSteps, n * 10);
+        windowStart = windowEnd;
+    }
+    velocity->FinishTimeWindows();
 
     if (happened)
         return ADVECT_HAPPENED;
@@ -350,139 +410,537 @@ int Advection::AdvectTillTime(Field *velocity, double startT, double deltaT, dou
         return 0;
 }
 
-int Advection::CalculateParticleValues(Field *scalar, bool skipNonZero)
+bool Advection::_advectStreamTillTime(Field *velocity, size_t streamIdx, double deltaT, double endT, bool fixedStepSize, ADVECTION_METHOD method, size_t maxSteps, size_t &thisStep,
+                                      bool &happened, bool &hitLimit)
 {
-    // For steady fields, we calculate values one stream at a time
-    if (scalar->IsSteady) {
-        if (scalar->LockParams() != 0) return PARAMS_ERROR;
+    auto &   s = _streams[streamIdx];
+    Particle p0 = s.back();    // Start from the last particle in this stream
+
+    while (p0.time < endT) {
+
+        // Check if the particle is inside of the volume.
+        // Wrap it along periodic dimensions if applicable.
+        if (!velocity->InsideVolumeVelocity(p0.time, p0.location)) {
+            bool locChanged = false;
+            auto itr = s.end();
+            --itr;    // pointing to the last element
+            auto loc = itr->location;
+            for (int i = 0; i < 3; i++) {
+                if (_isPeriodic[i]) {
+                    loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
+                    locChanged = true;
+                }
+            }
+            if (!locChanged) {  // no dimension is periodic, append a separator
+                Particle separator;
+                separator.SetSpecial(true);
+                s.push_back(separator);
+                _separatorCount[streamIdx]++;
+                return true;
+            }
 
-        _valueVarName = scalar->ScalarName;
+            // See if the new location is inside of the volume
+            if (velocity->InsideVolumeVelocity(itr->time, loc)) {
+                itr->location = loc;
+                p0 = *itr;    // p0 is equal to the wrapped particle
 
-        for (auto &s : _streams) {
-            for (auto &p : s) {
-                // Skip this particle if it's a separator
-                if (p.IsSpecial()) continue;
+                Particle separator;
+                separator.SetSpecial(true);
+                s.insert(itr, separator);
+                _separatorCount[streamIdx]++;
+            } else {  // Still outside, so we terminate the stream!
+                Particle separator;
+                separator.SetSpecial(true);
+                s.push_back(separator);
+                _separatorCount[streamIdx]++;
+                return true;
+            }
+        } // Finish the out-of-volume condition
+
+        double dt = deltaT;
+        if (method == ADVECTION_METHOD::RK45) {
+            // RK45 takes the step size suggested by its error control, within the same limits.
+            double next = _rk45States[streamIdx].nextDt;
+            if (!fixedStepSize && next > 0.0) dt = glm::clamp(next, deltaT / 20.0, deltaT * 20.0);
+        }
+        else if (!fixedStepSize && s.size() > 2)
+        {
+            double mindt = deltaT / 20.0, maxdt = deltaT * 20.0;
+            const auto &past1 = s[s.size() - 2];
+            const auto &past2 = s[s.size() - 3];
+            if ((!past1.IsSpecial()) && (!past2.IsSpecial())) {
+                dt = p0.time - past1.time;    // step size used by last integration
+                dt *= _calcAdjustFactor(past2, past1, p0);
+                dt = glm::clamp(dt, mindt, maxdt);
+            }
+        }
+
+        // Never step past the end of the window, so that the field is only
+        // evaluated within the window it was prepared for. A step that reaches
+        // the end lands exactly on it. A step that would stop just short of
+        // the end is stretched to reach it, rather than leaving a sliver of
+        // a step that barely moves the particle.
+        const double unclampedDt = dt;
+        bool         toEnd = dt * 1.001 >= endT - p0.time;
+        if (toEnd) dt = endT - p0.time;
+
+        Particle p1;
+        int      rv = 0;
+        switch (method) {
+        case ADVECTION_METHOD::EULER:
+            rv = _advectEuler(velocity, p0, dt, p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            break;
+        case ADVECTION_METHOD::RK4:
+            rv = _advectRK4(velocity, p0, dt, p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            break;
+        case ADVECTION_METHOD::RK45: {
+            const double tryDt = dt;
+            rv = _advectRK45(velocity, p0, dt, fixedStepSize ? dt : std::min(dt, deltaT / 20.0), fixedStepSize, _rk45States[streamIdx], p1);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            // A rejected step no longer reaches the end. One that does was cut short by the
+            // window, so it says nothing about the step size to use next.
+            if (dt != tryDt)
+                toEnd = false;
+            else if (toEnd)
+                _rk45States[streamIdx].nextDt = std::max(_rk45States[streamIdx].nextDt, unclampedDt);
+            break;
+        }
+        }
 
-                // Do not evaluate this particle if its value is non-zero
-                if (skipNonZero && p.value != 0.0f) continue;
+        if (rv == SUCCESS) {
+            if (toEnd) p1.time = endT;
+            // Check out Bookmark_1
+            if (p1.location == p0.location) {
+                p1.SetSpecial(true);
+                s.push_back(p1);
+                _separatorCount[streamIdx]++;
+                return true;
+            } else {
+                happened = true;
+                s.push_back(p1);
+                p0 = p1;
+            }
+        } else if (rv == MISSING_VAL) {
+            // Check out Bookmark_2
+            glm::vec3 vel;
+            bool isMissing = (velocity->GetVelocity(p0.time, p0.location, vel) == MISSING_VAL);
+            bool isInside = velocity->InsideVolumeVelocity(p0.time, p0.location);
 
-                float value;
-                int   rv = scalar->GetScalar(p.time, p.location, value);
-                if (rv == 0)            // The end of a stream could be outside of the volume,
-                    p.value = value;    // so let's only color it when the return value is 0.
+            if (isInside && isMissing) {
+                p1.SetSpecial(true);
+                s.push_back(p1);
+                _separatorCount[streamIdx]++;
+                return true;
+            } else if (isInside && (!isMissing)) {
+                rv = _advectEuler(velocity, p0, dt, p1);
+                assert(rv == 0);
+                if (toEnd) p1.time = endT;
+                s.push_back(p1);
+                p0 = p1;
+            } else {
+                auto loc = p0.location;
+                for (int i = 0; i < 3; i++) {
+                    if (_isPeriodic[i])
+                        loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
+                }
+
+                if (velocity->InsideVolumeVelocity(p0.time, loc)) {
+                    p1.SetSpecial(true);
+                    auto it = s.end();
+                    --it;
+                    s.insert(it, p1);
+                    it = s.end();
+                    --it;
+                    it->location = loc;
+                    _separatorCount[streamIdx]++;
+                } else {
+                    p1.SetSpecial(true);
+                    s.push_back(p1);
+                    _separatorCount[streamIdx]++;
+                    return true;
+                }
             }
+        } // finish handling missing value
+
+        if (++thisStep == maxSteps) {
+            hitLimit = true;
+            p1.SetSpecial(true);
+            s.push_back(p1);
+            _separatorCount[streamIdx]++;
+            return true;
         }
+    }    // Finish advecting one particle
+
+    return false;
+}
 
-        scalar->UnlockParams();
+int Advection::AdvectFlowMap(Field *velocity, double startT, double endT, double deltaT, std::vector<glm::vec3> &positions, std::vector<char> &valid, ADVECTION_METHOD method) const
+{
+    valid.assign(positions.size(), 1);
+    if (positions.empty()) return NO_SEED_PARTICLE_YET;
+    if (deltaT == 0.0 || startT == endT) return NO_ADVECT_HAPPENED;
+
+    // For steady fields, the params stay locked while advecting
+    if (velocity->IsSteady && velocity->LockParams() != 0) return PARAMS_ERROR;
+
+    // The same time-window scheduling as AdvectTillTime(), in either direction.
+    // All seeds take the same steps, so they all reach the end of a window together.
+    const bool          forward = endT > startT;
+    std::vector<double> windowEnds;
+    if (!velocity->IsSteady) {
+        for (double t : velocity->GetTimestamps()) {
+            if (t > std::min(startT, endT) && t < std::max(startT, endT)) windowEnds.push_back(t);
+        }
+        if (!forward) std::reverse(windowEnds.begin(), windowEnds.end());
     }
-    // For unsteady fields, we calculate values at one timestep at a time
-    else {
-        size_t mostSteps = 0;
-        for (auto &s : _streams) {
-            if (s.size() > mostSteps) mostSteps = s.size();
+    windowEnds.push_back(endT);
+
+    const double step = forward ? std::abs(deltaT) : -std::abs(deltaT);
+    double       windowStart = startT;
+    for (double windowEnd : windowEnds) {
+        // The field loads ahead in time only, so only forward advection prefetches
+        velocity->PrepareTimeWindow(std::min(windowStart, windowEnd), std::max(windowStart, windowEnd), forward && windowEnd != endT);
+
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (long i = 0; i < (long)positions.size(); i++) {
+            if (valid[i]) valid[i] = _advectFlowMapSeed(velocity, windowStart, windowEnd, step, method, positions[i]);
         }
 
-        _valueVarName = scalar->ScalarName;
+        windowStart = windowEnd;
+    }
+    velocity->FinishTimeWindows();
 
-        for (size_t i = 0; i < mostSteps; i++) {
-            for (auto &s : _streams) {
-                if (i < s.size()) {
-                    auto &p = s[i];
-                    if (p.IsSpecial()) continue;
+    if (velocity->IsSteady) velocity->UnlockParams();
 
-                    // Do not evaluate this particle if its value is non-zero
-                    if (skipNonZero && p.value != 0.0f) continue;
+    if (std::find(valid.cbegin(), valid.cend(), 1) != valid.cend())
+        return SUCCESS;
+    else
+        return NO_ADVECT_HAPPENED;
+}
 
-                    float val;
-                    int   rv = scalar->GetScalar(p.time, p.location, val);
-                    if (rv == 0) p.value = val;
+bool Advection::_advectFlowMapSeed(Field *velocity, double t0, double t1, double deltaT, ADVECTION_METHOD method, glm::vec3 &location) const
+{
+    Particle  p0(location, t0), p1;
+    RK45State state;
+
+    while (p0.time != t1) {
+        // The last step lands exactly on t1. See _advectStreamTillTime().
+        double     dt = deltaT;
+        const bool toEnd = std::abs(dt) * 1.001 >= std::abs(t1 - p0.time);
+        if (toEnd) dt = t1 - p0.time;
+
+        int rv = 0;
+        switch (method) {
+        case ADVECTION_METHOD::EULER: rv = _advectEuler(velocity, p0, dt, p1); break;
+        case ADVECTION_METHOD::RK4: rv = _advectRK4(velocity, p0, dt, p1); break;
+        case ADVECTION_METHOD::RK45: rv = _advectRK45(velocity, p0, dt, dt, true, state, p1); break;
+        }
+
+        if (rv == MISSING_VAL) {
+            // Check out Bookmark_2
+            glm::vec3 vel;
+            bool      isMissing = (velocity->GetVelocity(p0.time, p0.location, vel) == MISSING_VAL);
+            bool      isInside = velocity->InsideVolumeVelocity(p0.time, p0.location);
+
+            if (isInside && isMissing) break;
+            if (isInside) {
+                rv = _advectEuler(velocity, p0, dt, p1);
+            } else {
+                auto loc = p0.location;
+                for (int i = 0; i < 3; i++) {
+                    if (_isPeriodic[i]) loc[i] = _applyPeriodic(loc[i], _periodicBounds[i][0], _periodicBounds[i][1]);
                 }
-            }    // end of a stream
-        }        // end of all steps
+                if (loc == p0.location || !velocity->InsideVolumeVelocity(p0.time, loc)) break;
+                p0.location = loc;
+                continue;
+            }
+        }
+        if (rv != SUCCESS) break;
+
+        p0.location = p1.location;
+        p0.time = toEnd ? t1 : p1.time;
     }
 
-    return 0;
+    location = p0.location;
+    return p0.time == t1;
 }
 
+VAPoR::RegularGrid *Advection::CalculateFTLE(Field *velocity, double startT, double endT, double deltaT, const VAPoR::DimsType &dims, const VAPoR::CoordType &minu,
+                                             const VAPoR::CoordType &maxu, std::vector<float> &values, ADVECTION_METHOD method) const
+{
+    const size_t nx = dims[0], ny = dims[1], nz = dims[2];
+    const size_t n = nx * ny * nz;
+    if (n == 0 || startT == endT) return nullptr;
+
+    // Seed at every lattice node
+    glm::vec3 spacing(0.0f);
+    for (int a = 0; a < 3; a++) {
+        if (dims[a] > 1) spacing[a] = float((maxu[a] - minu[a]) / (dims[a] - 1));
+    }
+    std::vector<glm::vec3> positions(n);
+    for (size_t k = 0; k < nz; k++)
+        for (size_t j = 0; j < ny; j++)
+            for (size_t i = 0; i < nx; i++)
+                positions[(k * ny + j) * nx + i] = glm::vec3(float(minu[0]), float(minu[1]), float(minu[2])) + glm::vec3(float(i), float(j), float(k)) * spacing;
+
+    std::vector<glm::vec3> ends = positions;
+    std::vector<char>      valid;
+    if (AdvectFlowMap(velocity, startT, endT, deltaT, ends, valid, method) != SUCCESS) return nullptr;
+
+    const float missingValue = std::numeric_limits<float>::infinity();
+    FlowMapToFTLE(dims, positions, ends, valid, std::abs(endT - startT), values);
+
+    std::vector<float *> blks = {values.data()};
+    auto *               grid = new VAPoR::RegularGrid(dims, dims, blks, minu, maxu);
+    grid->SetMissingValue(missingValue);
+    grid->SetHasMissingValues(true);
+    return grid;
+}
 
-int Advection::CalculateParticleIntegratedValues(Field *scalar, const bool skipNonZero, const float distScale, const std::vector<double> &integrateWithinVolumeMin,
-                                                 const std::vector<double> &integrateWithinVolumeMax)
+int Advection::CalculateFTLE(Field *velocity, double startT, double endT, double deltaT, const VAPoR::Grid &mesh, std::vector<float> &values, ADVECTION_METHOD method) const
 {
-    // For steady fields, we calculate values one stream at a time
-    if (scalar->IsSteady) {
-        if (scalar->LockParams() != 0) return PARAMS_ERROR;
+    const VAPoR::DimsType dims = mesh.GetDimensions();
+    const size_t          nx = dims[0], ny = dims[1], nz = dims[2];
+    const size_t          n = nx * ny * nz;
+    if (n == 0 || startT == endT) return PARAMS_ERROR;
+
+    // Seed at every mesh node
+    std::vector<glm::vec3> positions(n);
+    #pragma omp parallel for schedule(static)
+    for (long l = 0; l < (long)n; l++) {
+        VAPoR::CoordType coords;
+        mesh.GetUserCoordinates(VAPoR::DimsType{size_t(l) % nx, (size_t(l) / nx) % ny, size_t(l) / (nx * ny)}, coords);
+        positions[l] = glm::vec3(float(coords[0]), float(coords[1]), float(coords[2]));
+    }
 
-        _valueVarName = scalar->ScalarName;
+    std::vector<glm::vec3> ends = positions;
+    std::vector<char>      valid;
+    int                    rv = AdvectFlowMap(velocity, startT, endT, deltaT, ends, valid, method);
+    if (rv != SUCCESS) return rv;
 
-        for (auto &s : _streams) {
-            if (s.size() && !s[0].IsSpecial()) s[0].value = 0;
+    FlowMapToFTLE(dims, positions, ends, valid, std::abs(endT - startT), values);
+    return SUCCESS;
+}
 
-            for (int i = 1; i < s.size(); i++) {
-                auto &prev = s[i - 1];
-                auto &p = s[i];
-                _calculateParticleIntegratedValue(p, prev, scalar, skipNonZero, distScale, integrateWithinVolumeMin, integrateWithinVolumeMax);
-            }
-        }
+int Advection::CalculateParticleValues(Field *scalar, bool skipNonZero, size_t sampleStride)
+{
+    // For steady fields, the params stay locked while sampling
+    if (scalar->IsSteady && scalar->LockParams() != 0) return PARAMS_ERROR;
+
+    _valueVarName = scalar->ScalarName;
+    _hasValueRange = false;
 
-        scalar->UnlockParams();
+    // Flag the particles to evaluate: skip separators, and
+    // do not evaluate a particle if its value is non-zero.
+    std::vector<char> need;
+    for (const auto &s : _streams)
+        for (const auto &p : s) need.push_back(!p.IsSpecial() && !(skipNonZero && p.value != 0.0f));
+
+    std::vector<float> values;
+    std::vector<char>  valid;
+    _sampleScalar(scalar, sampleStride, need, values, valid);
+
+    std::vector<size_t> offsets(1, 0);
+    for (const auto &s : _streams) offsets.push_back(offsets.back() + s.size());
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long i = 0; i < (long)_streams.size(); i++) {
+        auto &s = _streams[i];
+        for (size_t j = 0; j < s.size(); j++) {
+            const size_t idx = offsets[i] + j;
+            if (need[idx] && valid[idx])    // The end of a stream could be outside of the volume,
+                s[j].value = values[idx];   // so let's only color it when the sampling succeeded.
+        }
     }
-    // For unsteady fields, we calculate values at one timestep at a time
-    else {
-        size_t mostSteps = 0;
-        for (auto &s : _streams) {
-            if (s.size() > mostSteps) mostSteps = s.size();
+
+    if (scalar->IsSteady) scalar->UnlockParams();
+
+    return 0;
+}
+
+
+int Advection::CalculateParticleIntegratedValues(Field *scalar, const bool skipNonZero, const float distScale, const std::vector<double> &integrateWithinVolumeMin,
+                                                 const std::vector<double> &integrateWithinVolumeMax, size_t sampleStride)
+{
+    // For steady fields, the params stay locked while sampling
+    if (scalar->IsSteady && scalar->LockParams() != 0) return PARAMS_ERROR;
+
+    _valueVarName = scalar->ScalarName;
+    _hasValueRange = false;
+
+    // The integrand is needed at every particle that follows another particle,
+    // has a zero value if "skipNonZero" is set, and is within the integration volume.
+    std::vector<char> need;
+    for (const auto &s : _streams) {
+        for (size_t j = 0; j < s.size(); j++) {
+            const auto &p = s[j];
+            need.push_back(j > 0 && !p.IsSpecial() && !s[j - 1].IsSpecial() && !(skipNonZero && p.value != 0.0f)
+                           && _isParticleInsideVolume(p, integrateWithinVolumeMin, integrateWithinVolumeMax));
         }
+    }
 
-        _valueVarName = scalar->ScalarName;
+    std::vector<float> values;
+    std::vector<char>  valid;
+    _sampleScalar(scalar, sampleStride, need, values, valid);
+
+    std::vector<size_t> offsets(1, 0);
+    for (const auto &s : _streams) offsets.push_back(offsets.back() + s.size());
+
+    // The integration itself runs along each stream, but streams are independent.
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long i = 0; i < (long)_streams.size(); i++) {
+        auto &s = _streams[i];
+        if (s.size() && !s[0].IsSpecial()) s[0].value = 0;
+
+        for (size_t j = 1; j < s.size(); j++) {
+            auto &      p = s[j];
+            const auto &prev = s[j - 1];
+            const auto  idx = offsets[i] + j;
+
+            // Skip this particle if it is a separator
+            if (p.IsSpecial()) continue;
+            if (prev.IsSpecial()) {
+                p.value = 0;
+                continue;
+            }
 
-        for (auto &s : _streams)
-            if (s.size() && !s[0].IsSpecial()) s[0].value = 0;
+            // Do not evaluate this particle if its value is non-zero
+            if (skipNonZero && p.value != 0.0f) continue;
 
-        for (size_t i = 1; i < mostSteps; i++) {
-            for (auto &s : _streams) {
-                if (i < s.size()) {
-                    auto &prev = s[i - 1];
-                    auto &p = s[i];
-                    _calculateParticleIntegratedValue(p, prev, scalar, skipNonZero, distScale, integrateWithinVolumeMin, integrateWithinVolumeMax);
-                }
-            }    // end of a stream
-        }        // end of all steps
+            // Outside of the integration volume, or outside of the volume
+            if (!need[idx] || !valid[idx]) {
+                p.value = prev.value;
+                continue;
+            }
+
+            float dist = glm::distance(prev.location, p.location);
+            p.value = prev.value + values[idx] * dist * distScale;
+        }
     }
 
+    if (scalar->IsSteady) scalar->UnlockParams();
+
     return 0;
 }
 
-void Advection::_calculateParticleIntegratedValue(Particle &p, const Particle &prev, const Field *scalarField, const bool skipNonZero, const float distScale,
-                                                  const std::vector<double> &integrateWithinVolumeMin, const std::vector<double> &integrateWithinVolumeMax) const
+void Advection::_sampleScalar(Field *scalar, size_t sampleStride, const std::vector<char> &need, std::vector<float> &values, std::vector<char> &valid) const
 {
-    // Skip this particle if it is a separator
-    if (p.IsSpecial()) return;
-    if (prev.IsSpecial()) {
-        p.value = 0;
+    std::vector<const Particle *> parts;
+    for (const auto &s : _streams)
+        for (const auto &p : s) parts.push_back(&p);
+    assert(need.size() == parts.size());
+
+    values.assign(parts.size(), std::nanf("1"));
+    valid.assign(parts.size(), 0);
+
+    if (sampleStride <= 1) {
+        std::vector<size_t> which;
+        for (size_t i = 0; i < need.size(); i++)
+            if (need[i]) which.push_back(i);
+        _evaluateScalar(scalar, parts, which, values, valid);
         return;
     }
 
-    // Do not evaluate this particle if its value is non-zero
-    if (skipNonZero && p.value != 0.0f) return;
+    // Pick the end points of spans of up to sampleStride steps within each segment
+    // of a stream, where segments are separated by special particles. Only spans
+    // that contain a particle in need are sampled.
+    std::vector<std::pair<size_t, size_t>> spans;
+    size_t                                 offset = 0;
+    for (const auto &s : _streams) {
+        size_t begin = 0;
+        while (begin < s.size()) {
+            if (s[begin].IsSpecial()) {
+                begin++;
+                continue;
+            }
+            size_t end = begin;
+            while (end + 1 < s.size() && !s[end + 1].IsSpecial()) end++;
 
-    if (!_isParticleInsideVolume(p, integrateWithinVolumeMin, integrateWithinVolumeMax)) {
-        p.value = prev.value;
-        return;
+            for (size_t a = begin; a <= end; a += sampleStride) {
+                size_t b = std::min(a + sampleStride, end);
+                if (std::any_of(need.begin() + offset + a, need.begin() + offset + b + 1, [](char c) { return c != 0; })) spans.emplace_back(offset + a, offset + b);
+                if (b == end) break;
+            }
+            begin = end + 1;
+        }
+        offset += s.size();
     }
 
-    float value;
-    int   rv = scalarField->GetScalar(p.time, p.location, value);
-    if (rv != 0) {    // If non-0, then outside the volume
-        p.value = prev.value;
-        return;
+    std::vector<size_t> which;
+    for (const auto &span : spans) {
+        if (which.empty() || which.back() != span.first) which.push_back(span.first);
+        if (span.second != span.first) which.push_back(span.second);
     }
+    _evaluateScalar(scalar, parts, which, values, valid);
+
+    // Fill the particles in between, or sample them directly when
+    // either end of their span is not available.
+    std::vector<size_t> direct;
+    for (const auto &span : spans) {
+        const size_t a = span.first, b = span.second;
+        for (size_t i = a + 1; i < b; i++) {
+            if (!need[i]) continue;
+            if (valid[a] && valid[b]) {
+                values[i] = glm::mix(values[a], values[b], float(i - a) / float(b - a));
+                valid[i] = 1;
+            } else
+                direct.push_back(i);
+        }
+    }
+    _evaluateScalar(scalar, parts, direct, values, valid);
+}
 
-    float dist = glm::distance(prev.location, p.location);
-    p.value = prev.value + value * dist * distScale;
+void Advection::_evaluateScalar(Field *scalar, const std::vector<const Particle *> &parts, const std::vector<size_t> &which, std::vector<float> &values, std::vector<char> &valid) const
+{
+    if (which.empty()) return;
+
+    // Group the particles by the pair of time steps bracketing them. A steady
+    // field, or one without time stamps, forms a single group.
+    std::vector<std::vector<size_t>> groups;
+    const auto                       timestamps = scalar->IsSteady ? std::vector<double>() : scalar->GetTimestamps();
+    if (timestamps.empty())
+        groups.push_back(which);
+    else {
+        groups.resize(timestamps.size() + 1);
+        for (size_t i : which) {
+            auto bracket = std::upper_bound(timestamps.begin(), timestamps.end(), parts[i]->time) - timestamps.begin();
+            groups[bracket].push_back(i);
+        }
+    }
+
+    size_t lastGroup = 0;
+    for (size_t g = 0; g < groups.size(); g++)
+        if (!groups[g].empty()) lastGroup = g;
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        const auto &group = groups[g];
+        if (group.empty()) continue;
+
+        double t0 = parts[group[0]]->time, t1 = t0;
+        for (size_t i : group) {
+            t0 = std::min(t0, parts[i]->time);
+            t1 = std::max(t1, parts[i]->time);
+        }
+
+        // If the field cannot prepare this time window, query it serially instead.
+        const bool prepared = scalar->PrepareTimeWindow(t0, t1, g < lastGroup) == 0;
+
+        #pragma omp parallel for schedule(dynamic, 256) if (prepared)
+        for (long k = 0; k < (long)group.size(); k++) {
+            const size_t i = group[k];
+            float        val = std::nanf("1");
+            valid[i] = scalar->GetScalar(parts[i]->time, parts[i]->location, val) == 0;
+            values[i] = val;
+        }
+    }
+    scalar->FinishTimeWindows();
 }
 
 void Advection::SetAllStreamValuesToFinalValue(int realNSamples)
 {
+    _hasValueRange = false;
     for (auto &s : _streams) {
         float finalValue = 0;
 
@@ -506,7 +964,7 @@ void Advection::SetAllStreamValuesToFinalValue(int realNSamples)
     }
 }
 
-int Advection::CalculateParticleProperties(Field *scalar)
+int Advection::CalculateParticleProperties(Field *scalar, size_t sampleStride)
 {
     // Test if this scalar property is already calculated.
     if (std::find(_propertyVarNames.cbegin(), _propertyVarNames.cend(), scalar->ScalarName) != _propertyVarNames.cend()) return 0;
@@ -525,61 +983,85 @@ int Advection::CalculateParticleProperties(Field *scalar)
     }
 
     // In case this property field is a brand new variable, we do the actual sampling work.
-    if (scalar->IsSteady) {
-        if (scalar->LockParams() != 0) return PARAMS_ERROR;
-
-        for (auto &s : _streams) {
-            for (auto &p : s) {
-                if (p.IsSpecial()) continue;
+    if (scalar->IsSteady && scalar->LockParams() != 0) return PARAMS_ERROR;
 
-                // At the end of a flow line, a particle might be outside of the volume.
-                // We attach something in that case as well.
-                float val = std::nanf("1");
-                scalar->GetScalar(p.time, p.location, val);
-                p.AttachProperty(val);
-            }
-        }
-    } 
-    else {
-        size_t mostSteps = 0;
-        for (const auto &s : _streams)
-            if (s.size() > mostSteps) mostSteps = s.size();
-
-        for (size_t i = 0; i < mostSteps; i++) {
-            for (auto &s : _streams) {
-                if (i < s.size()) {
-                    auto &p = s[i];
-                    if (p.IsSpecial()) continue;
-
-                    float value = std::nanf("1");
-                    scalar->GetScalar(p.time, p.location, value);
-                    p.AttachProperty(value);
-                }
-            }
-        }
+    std::vector<char> need;
+    for (const auto &s : _streams)
+        for (const auto &p : s) need.push_back(!p.IsSpecial());
+
+    std::vector<float> values;
+    std::vector<char>  valid;
+    _sampleScalar(scalar, sampleStride, need, values, valid);
+
+    std::vector<size_t> offsets(1, 0);
+    for (const auto &s : _streams) offsets.push_back(offsets.back() + s.size());
+
+    // At the end of a flow line, a particle might be outside of the volume.
+    // We attach something in that case as well.
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (long i = 0; i < (long)_streams.size(); i++) {
+        auto &s = _streams[i];
+        for (size_t j = 0; j < s.size(); j++)
+            if (need[offsets[i] + j]) s[j].AttachProperty(values[offsets[i] + j]);
     }
 
+    if (scalar->IsSteady) scalar->UnlockParams();
+
     return 0;
 }
 
 void Advection::CalculateParticleHistogram(std::vector<double> &outBounds, std::vector<long> &bins)
 {
-    std::vector<float> samples;
-
-    for (const auto &s : _streams)
-        for (const auto &p : s)
-            if (!p.IsSpecial()) samples.push_back(p.value);
-
-    auto  bounds = std::minmax_element(samples.begin(), samples.end());
-    float minValue = *bounds.first;
-    float maxValue = *bounds.second;
-    float range = maxValue - minValue;
-
     int nBins = bins.size();
     assert(nBins != 0);
     std::fill(bins.begin(), bins.end(), 0);
 
-    for (const auto &s : samples) { bins[std::min(nBins - 1, std::max(0, (int)((nBins - 1) * (s - minValue) / range)))]++; }
+    // The range only changes with the particle values, so it's kept until they change,
+    // and a new bin count only costs the binning pass.
+    if (!_hasValueRange) {
+        float minValue = FLT_MAX, maxValue = -FLT_MAX;
+        #pragma omp parallel
+        {
+            float threadMin = FLT_MAX, threadMax = -FLT_MAX;
+            #pragma omp for schedule(dynamic, 16) nowait
+            for (long i = 0; i < (long)_streams.size(); i++) {
+                for (const auto &p : _streams[i]) {
+                    if (p.IsSpecial()) continue;
+                    threadMin = std::min(threadMin, p.value);
+                    threadMax = std::max(threadMax, p.value);
+                }
+            }
+            #pragma omp critical
+            {
+                minValue = std::min(minValue, threadMin);
+                maxValue = std::max(maxValue, threadMax);
+            }
+        }
+        // Without any value, report an empty histogram over [0, 0]
+        if (minValue > maxValue) minValue = maxValue = 0.0f;
+        _valueRange = {minValue, maxValue};
+        _hasValueRange = true;
+    }
+
+    const float minValue = _valueRange[0];
+    const float maxValue = _valueRange[1];
+    const float range = maxValue - minValue;
+
+    // Each thread fills its own bins, which are added up at the end.
+    #pragma omp parallel
+    {
+        std::vector<long> threadBins(nBins, 0);
+        #pragma omp for schedule(dynamic, 16) nowait
+        for (long i = 0; i < (long)_streams.size(); i++) {
+            for (const auto &p : _streams[i]) {
+                if (p.IsSpecial()) continue;
+                int b = range > 0.0f ? (int)((nBins - 1) * (p.value - minValue) / range) : 0;
+                threadBins[std::min(nBins - 1, std::max(0, b))]++;
+            }
+        }
+        #pragma omp critical
+        for (int b = 0; b < nBins; b++) bins[b] += threadBins[b];
+    }
 
     outBounds.resize(2);
     outBounds[0] = minValue;
@@ -622,6 +1104,70 @@ int Advection::_advectRK4(Field *velocity, const Particle &p0, double dt, Partic
     return 0;
 }
 
+int Advection::_advectRK45(Field *velocity, const Particle &p0, double &dt, double minDt, bool fixedStepSize, RK45State &state, Particle &p1) const
+{
+    // Dormand-Prince coefficients. The 5th order solution uses the weights of the
+    // last stage, so the last stage of a step is the first stage of the next one.
+    const float c2 = 1.f / 5.f, c3 = 3.f / 10.f, c4 = 4.f / 5.f, c5 = 8.f / 9.f;
+    const float a21 = 1.f / 5.f;
+    const float a31 = 3.f / 40.f, a32 = 9.f / 40.f;
+    const float a41 = 44.f / 45.f, a42 = -56.f / 15.f, a43 = 32.f / 9.f;
+    const float a51 = 19372.f / 6561.f, a52 = -25360.f / 2187.f, a53 = 64448.f / 6561.f, a54 = -212.f / 729.f;
+    const float a61 = 9017.f / 3168.f, a62 = -355.f / 33.f, a63 = 46732.f / 5247.f, a64 = 49.f / 176.f, a65 = -5103.f / 18656.f;
+    const float b1 = 35.f / 384.f, b3 = 500.f / 1113.f, b4 = 125.f / 192.f, b5 = -2187.f / 6784.f, b6 = 11.f / 84.f;
+    // Differences between the 5th and the embedded 4th order weights
+    const float e1 = 71.f / 57600.f, e3 = -71.f / 16695.f, e4 = 71.f / 1920.f, e5 = -17253.f / 339200.f, e6 = 22.f / 525.f, e7 = -1.f / 40.f;
+
+    glm::vec3 k1, k2, k3, k4, k5, k6, k7;
+    int       rv = 0;
+    if (state.hasK1 && state.k1Location == p0.location)
+        k1 = state.k1;
+    else {
+        rv = velocity->GetVelocity(p0.time, p0.location, k1);
+        _printNonZero(rv, __FILE__, __func__, __LINE__);
+        if (rv != 0) return rv;
+    }
+
+    while (true) {
+        const float h = float(dt);    // glm is strict about data types (which is a good thing).
+        rv = velocity->GetVelocity(p0.time + c2 * dt, p0.location + h * (a21 * k1), k2);
+        if (rv == 0) rv = velocity->GetVelocity(p0.time + c3 * dt, p0.location + h * (a31 * k1 + a32 * k2), k3);
+        if (rv == 0) rv = velocity->GetVelocity(p0.time + c4 * dt, p0.location + h * (a41 * k1 + a42 * k2 + a43 * k3), k4);
+        if (rv == 0) rv = velocity->GetVelocity(p0.time + c5 * dt, p0.location + h * (a51 * k1 + a52 * k2 + a53 * k3 + a54 * k4), k5);
+        if (rv == 0) rv = velocity->GetVelocity(p0.time + dt, p0.location + h * (a61 * k1 + a62 * k2 + a63 * k3 + a64 * k4 + a65 * k5), k6);
+        const glm::vec3 y5 = p0.location + h * (b1 * k1 + b3 * k3 + b4 * k4 + b5 * k5 + b6 * k6);
+        if (rv == 0) rv = velocity->GetVelocity(p0.time + dt, y5, k7);
+
+        // A stage may leave the volume because the step is too long.
+        if (rv != 0) {
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
+            if (fixedStepSize || std::abs(dt) <= std::abs(minDt)) return rv;
+            dt = (std::abs(dt * 0.5) > std::abs(minDt)) ? dt * 0.5 : minDt;
+            continue;
+        }
+
+        const double err = glm::length(h * (e1 * k1 + e3 * k3 + e4 * k4 + e5 * k5 + e6 * k6 + e7 * k7));
+        const double tol = _rk45AbsTol + _rk45RelTol * glm::length(y5 - p0.location);
+        const double ratio = (tol > 0.0) ? err / tol : (err > 0.0 ? DBL_MAX : 0.0);
+
+        // The usual step size controller, changing the step by at most 5X.
+        const double factor = (ratio > 0.0) ? glm::clamp(0.9 * std::pow(ratio, -0.2), 0.2, 5.0) : 5.0;
+
+        if (fixedStepSize || ratio <= 1.0 || std::abs(dt) <= std::abs(minDt)) {
+            p1.location = y5;
+            p1.time = p0.time + dt;
+            state.nextDt = dt * factor;
+            state.k1 = k7;
+            state.k1Location = y5;
+            state.hasK1 = true;
+            return 0;
+        }
+
+        // Rejected: retry with a smaller step
+        dt = (std::abs(dt * factor) > std::abs(minDt)) ? dt * factor : minDt;
+    }
+}
+
 float Advection::_calcAdjustFactor(const Particle &p2, const Particle &p1, const Particle &p0) const
 {
     glm::vec3 p2p1 = p1.location - p2.location;
@@ -686,6 +1232,7 @@ void Advection::RemoveParticleProperty(const std::string &varToRemove)
 
 void Advection::ResetParticleValues()
 {
+    _hasValueRange = false;
     for (auto &stream : _streams) {
         std::for_each(stream.begin(), stream.end(), [](Particle &p) {
             if (!p.IsSpecial()) p.value = 0.0f;
@@ -0,0 +1,207 @@
+#ifdef WIN32
+    #define _USE_MATH_DEFINES
+#endif
+#include "vapor/AnalyticField.h"
+#include "vapor/RegularGrid.h"
+#include "vapor/StretchedGrid.h"
+#include "vapor/LayeredGrid.h"
+#include "vapor/CurvilinearGrid.h"
+#include <cmath>
+
+using namespace flow;
+
+// ===================================
+//            AnalyticField
+// ===================================
+
+AnalyticField::AnalyticField(glm::vec3 domainMin, glm::vec3 domainMax) : _domainMin(domainMin), _domainMax(domainMax) {}
+
+bool AnalyticField::InsideVolumeVelocity(double time, glm::vec3 pos) const
+{
+    for (int i = 0; i < 3; i++) {
+        if (pos[i] < _domainMin[i] || pos[i] > _domainMax[i]) return false;
+    }
+    return true;
+}
+
+int AnalyticField::GetVelocity(double time, glm::vec3 pos, glm::vec3 &vel) const
+{
+    if (!InsideVolumeVelocity(time, pos)) return MISSING_VAL;
+    vel = Evaluate(time, pos);
+    return 0;
+}
+
+int AnalyticField::GetScalar(double time, glm::vec3 pos, float &val) const
+{
+    if (!InsideVolumeScalar(time, pos)) return MISSING_VAL;
+    val = glm::length(Evaluate(time, pos));
+    return 0;
+}
+
+void AnalyticField::GetDomain(glm::vec3 &min, glm::vec3 &max) const
+{
+    min = _domainMin;
+    max = _domainMax;
+}
+
+// ===================================
+//              ABCField
+// ===================================
+
+ABCField::ABCField(double A, double B, double C) : AnalyticField(glm::vec3(0.0f), glm::vec3(float(2.0 * M_PI))), _A(A), _B(B), _C(C) { IsSteady = true; }
+
+glm::vec3 ABCField::Evaluate(double time, glm::vec3 p) const
+{
+    return glm::vec3(_A * std::sin(p.z) + _C * std::cos(p.y), _B * std::sin(p.x) + _A * std::cos(p.z), _C * std::sin(p.y) + _B * std::cos(p.x));
+}
+
+// ===================================
+//           DoubleGyreField
+// ===================================
+
+DoubleGyreField::DoubleGyreField(double A, double epsilon, double omega)
+: AnalyticField(glm::vec3(0.0f), glm::vec3(2.0f, 1.0f, 1.0f)), _A(A), _epsilon(epsilon), _omega(omega)
+{
+    IsSteady = false;
+}
+
+glm::vec3 DoubleGyreField::Evaluate(double t, glm::vec3 p) const
+{
+    const double a = _epsilon * std::sin(_omega * t), b = 1.0 - 2.0 * a;
+    const double f = a * p.x * p.x + b * p.x, dfdx = 2.0 * a * p.x + b;
+    return glm::vec3(-M_PI * _A * std::sin(M_PI * f) * std::cos(M_PI * p.y), M_PI * _A * std::cos(M_PI * f) * std::sin(M_PI * p.y) * dfdx, 0.0);
+}
+
+// ===================================
+//          HillsVortexField
+// ===================================
+
+HillsVortexField::HillsVortexField(double a, double U) : AnalyticField(glm::vec3(float(-2.0 * a)), glm::vec3(float(2.0 * a))), _a(a), _U(U) { IsSteady = true; }
+
+glm::vec3 HillsVortexField::Evaluate(double time, glm::vec3 p) const
+{
+    // Velocity in cylindrical coordinates about the Z axis, with r the distance
+    // from the axis, from the Stokes stream function of the vortex.
+    // Both the radial velocity and the distance from the axis vanish on the axis,
+    // so the radial part is evaluated as (radial velocity / r) * (x, y).
+    const double x = p.x, y = p.y, z = p.z;
+    const double r2 = x * x + y * y, R2 = r2 + z * z, a2 = _a * _a;
+    double       ur_r, uz;
+    if (R2 < a2) {
+        ur_r = 1.5 * _U * z / a2;
+        uz = 1.5 * _U * (1.0 - (2.0 * r2 + z * z) / a2);
+    } else {
+        const double R = std::sqrt(R2), a3_R3 = a2 * _a / (R2 * R);
+        ur_r = 1.5 * _U * a3_R3 * z / R2;
+        uz = -_U * (1.0 - a3_R3) - 1.5 * _U * a3_R3 * r2 / R2;
+    }
+    return glm::vec3(ur_r * x, ur_r * y, uz);
+}
+
+// ===================================
+//            SampledField
+// ===================================
+
+namespace {
+// A monotonic map of [0, 1] onto itself, with nodes denser in some places than others
+double Stretch(double s) { return s - 0.5 * std::sin(2.0 * M_PI * s) / (2.0 * M_PI); }
+}    // namespace
+
+SampledField::SampledField(const AnalyticField &field, GRID_TYPE type, const VAPoR::DimsType &dims, const std::vector<double> &timestamps)
+{
+    glm::vec3 minu, maxu;
+    field.GetDomain(minu, maxu);
+    const glm::vec3        len = maxu - minu;
+    const size_t           nx = dims[0], ny = dims[1], nz = dims[2], n = nx * ny * nz;
+    const VAPoR::CoordType minc = {minu.x, minu.y, minu.z}, maxc = {maxu.x, maxu.y, maxu.z};
+    auto                   s = [](size_t i, size_t len) { return len > 1 ? double(i) / double(len - 1) : 0.0; };
+
+    // The coordinates, shared by the grids of all components and time steps
+    std::vector<double>                        xcoords(nx), ycoords(ny), zcoords(nz);
+    std::unique_ptr<VAPoR::RegularGrid>        zrg, xrg, yrg;
+    std::shared_ptr<const VAPoR::QuadTreeRectangleP> qtr;
+    for (size_t i = 0; i < nx; i++) xcoords[i] = minu.x + len.x * (type == GRID_TYPE::STRETCHED ? Stretch(s(i, nx)) : s(i, nx));
+    for (size_t j = 0; j < ny; j++) ycoords[j] = minu.y + len.y * (type == GRID_TYPE::STRETCHED ? Stretch(s(j, ny)) : s(j, ny));
+    for (size_t k = 0; k < nz; k++) zcoords[k] = minu.z + len.z * (type == GRID_TYPE::STRETCHED ? Stretch(s(k, nz)) : s(k, nz));
+
+    if (type == GRID_TYPE::LAYERED) {
+        // Layers bulge up and down in between flat top and bottom layers
+        float *z = _allocate(n);
+        for (size_t k = 0; k < nz; k++)
+            for (size_t j = 0; j < ny; j++)
+                for (size_t i = 0; i < nx; i++) {
+                    double sk = s(k, nz);
+                    double bulge = 0.3 * sk * (1.0 - sk) * std::sin(2.0 * M_PI * s(i, nx)) * std::sin(2.0 * M_PI * s(j, ny));
+                    z[(k * ny + j) * nx + i] = minu.z + len.z * (sk + bulge);
+                }
+        zrg.reset(new VAPoR::RegularGrid(dims, dims, {z}, minc, maxc));
+    } else if (type == GRID_TYPE::CURVILINEAR) {
+        // Grid lines wiggle in the interior, while the boundary stays a box
+        const VAPoR::DimsType  dims2d = {nx, ny, 1};
+        const VAPoR::CoordType min2d = {minu.x, minu.y, 0.0}, max2d = {maxu.x, maxu.y, 0.0};
+        float *                x = _allocate(nx * ny);
+        float *                y = _allocate(nx * ny);
+        for (size_t j = 0; j < ny; j++)
+            for (size_t i = 0; i < nx; i++) {
+                double u = s(i, nx), v = s(j, ny);
+                x[j * nx + i] = minu.x + len.x * (u + 0.3 * std::sin(2.0 * M_PI * u) * std::sin(M_PI * v) / (2.0 * M_PI));
+                y[j * nx + i] = minu.y + len.y * (v + 0.3 * std::sin(2.0 * M_PI * v) * std::sin(M_PI * u) / (2.0 * M_PI));
+            }
+        xrg.reset(new VAPoR::RegularGrid(dims2d, dims2d, {x}, min2d, max2d));
+        yrg.reset(new VAPoR::RegularGrid(dims2d, dims2d, {y}, min2d, max2d));
+    }
+
+    auto makeGrid = [&](float *data) -> VAPoR::Grid * {
+        switch (type) {
+        case GRID_TYPE::STRETCHED: return new VAPoR::StretchedGrid(dims, dims, {data}, xcoords, ycoords, zcoords);
+        case GRID_TYPE::LAYERED: return new VAPoR::LayeredGrid(dims, dims, {data}, xcoords, ycoords, *zrg);
+        case GRID_TYPE::CURVILINEAR: {
+            // All grids share the quad tree built by the first one
+            auto *cg = new VAPoR::CurvilinearGrid(dims, dims, {data}, *xrg, *yrg, zcoords, qtr);
+            qtr = cg->GetQuadTreeRectangle();
+            return cg;
+        }
+        default: return new VAPoR::RegularGrid(dims, dims, {data}, minc, maxc);
+        }
+    };
+
+    for (double t : timestamps) {
+        const VAPoR::Grid *components[3];
+        float *            data[3];
+        for (int c = 0; c < 3; c++) {
+            data[c] = _allocate(n);
+            _grids.emplace_back(makeGrid(data[c]));
+            components[c] = _grids.back().get();
+        }
+
+        // Sample at the node locations the grid reports
+        const VAPoR::Grid *g = components[0];
+        #pragma omp parallel for
+        for (long l = 0; l < (long)n; l++) {
+            VAPoR::CoordType coords;
+            g->GetUserCoordinates(VAPoR::DimsType{size_t(l) % nx, (size_t(l) / nx) % ny, size_t(l) / (nx * ny)}, coords);
+            glm::vec3 vel = field.Evaluate(t, glm::vec3(coords[0], coords[1], coords[2]));
+            for (int c = 0; c < 3; c++) data[c][l] = vel[c];
+        }
+
+        AddTimestep(t, components[0], components[1], components[2]);
+    }
+}
+
+SampledField::~SampledField() = default;
+
+float *SampledField::_allocate(size_t n)
+{
+    _blocks.emplace_back(new float[n]);
+    return _blocks.back().get();
+}
+
+const char *SampledField::GetGridTypeName(GRID_TYPE type)
+{
+    switch (type) {
+    case GRID_TYPE::STRETCHED: return "Stretched";
+    case GRID_TYPE::LAYERED: return "Layered";
+    case GRID_TYPE::CURVILINEAR: return "Curvilinear";
+    default: return "Regular";
+    }
+}
@@ -0,0 +1,157 @@
+#include "vapor/DerivedFTLE.h"
+#include "vapor/GridField.h"
+#include <limits>
+
+using namespace flow;
+
+DerivedFTLE::DerivedFTLE(std::string varName, VAPoR::DataMgr *dataMgr, const std::vector<std::string> &velocityNames, double duration, size_t steps)
+: DerivedDataVar(varName), _dataMgr(dataMgr), _velocityNames(velocityNames), _duration(duration), _steps(steps)
+{
+    _velocityNames.resize(3);
+}
+
+int DerivedFTLE::Initialize()
+{
+    if (_velocityNames[0].empty() || _duration == 0.0 || _steps == 0) {
+        SetErrMsg("Invalid FTLE parameters for %s", _derivedVarName.c_str());
+        return -1;
+    }
+    for (int i = 2; i >= 0; i--) {
+        VAPoR::DC::DataVar dvar;
+        if (!_velocityNames[i].empty() && !_dataMgr->GetDataVarInfo(_velocityNames[i], dvar)) {
+            SetErrMsg("Invalid velocity variable : %s", _velocityNames[i].c_str());
+            return -1;
+        }
+        if (i == 0) _velocityInfo = dvar;
+    }
+
+    // The FTLE is seeded at the nodes of the velocity mesh, and differentiated along
+    // its index directions, which unstructured meshes do not have.
+    VAPoR::DC::Mesh mesh;
+    if (!_dataMgr->GetMesh(_velocityInfo.GetMeshName(), mesh) || mesh.GetMeshType() != VAPoR::DC::Mesh::STRUCTURED) {
+        SetErrMsg("FTLE requires a structured mesh : %s", _velocityInfo.GetMeshName().c_str());
+        return -1;
+    }
+    return 0;
+}
+
+bool DerivedFTLE::GetBaseVarInfo(VAPoR::DC::BaseVar &var) const
+{
+    VAPoR::DC::DataVar dvar;
+    if (!GetDataVarInfo(dvar)) return false;
+    var = dvar;
+    return true;
+}
+
+bool DerivedFTLE::GetDataVarInfo(VAPoR::DC::DataVar &dvar) const
+{
+    if (_velocityInfo.GetMeshName().empty()) return false;
+
+    dvar = _velocityInfo;
+    dvar.SetName(_derivedVarName);
+    dvar.SetUnits("");
+    dvar.SetXType(VAPoR::DC::FLOAT);
+    dvar.SetWName("");
+    dvar.SetMaskvar("");
+    dvar.SetHasMissing(true);
+    dvar.SetMissingValue(std::numeric_limits<float>::infinity());
+    return true;
+}
+
+std::vector<std::string> DerivedFTLE::GetInputs() const
+{
+    std::vector<std::string> inputs;
+    for (const auto &v : _velocityNames) {
+        if (!v.empty()) inputs.push_back(v);
+    }
+    return inputs;
+}
+
+int DerivedFTLE::GetDimLensAtLevel(int level, std::vector<size_t> &dims_at_level, std::vector<size_t> &bs_at_level) const
+{
+    int rc = _dataMgr->GetDimLensAtLevel(_velocityNames[0], level, dims_at_level, -1);
+    if (rc < 0) return rc;
+
+    bs_at_level = std::vector<size_t>(dims_at_level.size(), 1);
+    return 0;
+}
+
+size_t DerivedFTLE::GetNumRefLevels() const { return _dataMgr->GetNumRefLevels(_velocityNames[0]); }
+
+std::vector<size_t> DerivedFTLE::GetCRatios() const { return _dataMgr->GetCRatios(_velocityNames[0]); }
+
+int DerivedFTLE::OpenVariableRead(size_t ts, int level, int lod)
+{
+    VAPoR::DC::FileTable::FileObject *f = new VAPoR::DC::FileTable::FileObject(ts, _derivedVarName, level, lod);
+    return _fileTable.AddEntry(f);
+}
+
+int DerivedFTLE::CloseVariable(int fd)
+{
+    VAPoR::DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+    if (!f) {
+        SetErrMsg("Invalid file descriptor : %d", fd);
+        return -1;
+    }
+    _fileTable.RemoveEntry(fd);
+    delete f;
+    return 0;
+}
+
+int DerivedFTLE::ReadRegion(int fd, const std::vector<size_t> &min, const std::vector<size_t> &max, float *region)
+{
+    VAPoR::DC::FileTable::FileObject *f = _fileTable.GetEntry(fd);
+    if (!f) {
+        SetErrMsg("Invalid file descriptor : %d", fd);
+        return -1;
+    }
+
+    const VAPoR::Grid *grids[3] = {nullptr, nullptr, nullptr};
+    int                rc = 0;
+    for (int i = 0; i < 3 && rc == 0; i++) {
+        if (_velocityNames[i].empty()) continue;
+        grids[i] = _dataMgr->GetVariable(f->GetTS(), _velocityNames[i], f->GetLevel(), f->GetLOD(), true);
+        if (!grids[i]) rc = -1;
+    }
+
+    if (rc == 0) {
+        GridField             velocity;
+        velocity.AddTimestep(0.0, grids[0], grids[1], grids[2]);
+        Advection             advection;
+        std::vector<float>    values;
+        const VAPoR::DimsType lattice = grids[0]->GetDimensions();
+        if (advection.CalculateFTLE(&velocity, 0.0, _duration, _duration / _steps, *grids[0], values) != 0) {
+            // No seed could be advected at all
+            values.assign(lattice[0] * lattice[1] * lattice[2], std::numeric_limits<float>::infinity());
+        }
+
+        // Copy the requested subregion
+        std::vector<size_t> lo(3, 0), hi(3, 0);
+        for (size_t i = 0; i < min.size() && i < 3; i++) {
+            lo[i] = min[i];
+            hi[i] = max[i];
+        }
+        float *dst = region;
+        for (size_t k = lo[2]; k <= hi[2]; k++)
+            for (size_t j = lo[1]; j <= hi[1]; j++)
+                for (size_t i = lo[0]; i <= hi[0]; i++) *dst++ = values[(k * lattice[1] + j) * lattice[0] + i];
+    } else {
+        SetErrMsg("Failed to read velocity for %s", _derivedVarName.c_str());
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (grids[i]) {
+            _dataMgr->UnlockGrid(grids[i]);
+            delete grids[i];
+        }
+    }
+    return rc;
+}
+
+bool DerivedFTLE::VariableExists(size_t ts, int reflevel, int lod) const
+{
+    for (const auto &v : _velocityNames) {
+        if (!v.empty() && !_dataMgr->VariableExists(ts, v, reflevel, lod)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#include "vapor/GridField.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace flow;
+
+GridField::GridField() { IsSteady = true; }
+
+void GridField::AddTimestep(double time, const VAPoR::Grid *u, const VAPoR::Grid *v, const VAPoR::Grid *w)
+{
+    std::array<const VAPoR::Grid *, 3> grids = {{u, v, w}};
+
+    // Have the grids compute their lazily evaluated extents now, so that
+    // they are never modified while queried from multiple threads.
+    for (const auto *g : grids) {
+        if (g) {
+            VAPoR::CoordType minu, maxu;
+            g->GetUserExtents(minu, maxu);
+        }
+    }
+
+    _timestamps.push_back(time);
+    _grids.push_back(grids);
+    IsSteady = _timestamps.size() < 2;
+}
+
+bool GridField::_locateTimestep(double time, size_t &floor) const
+{
+    if (_timestamps.empty()) return false;
+    if (IsSteady) {
+        floor = 0;
+        return true;
+    }
+    if (time < _timestamps.front() || time > _timestamps.back()) return false;
+
+    floor = std::upper_bound(_timestamps.cbegin(), _timestamps.cend(), time) - _timestamps.cbegin() - 1;
+    return true;
+}
+
+bool GridField::_insideAtTimestep(size_t ts, const VAPoR::CoordType &coords) const
+{
+    for (const auto *g : _grids[ts]) {
+        if (g && !g->InsideGrid(coords)) return false;
+    }
+    return true;
+}
+
+int GridField::_getVelocityAtTimestep(size_t ts, const VAPoR::CoordType &coords, glm::vec3 &vel) const
+{
+    for (int i = 0; i < 3; i++) {
+        const auto *g = _grids[ts][i];
+        vel[i] = 0.0f;
+        if (!g) continue;
+
+        float v = g->GetValue(coords);
+        float mv = g->GetMissingValue();
+        if (v == mv || (std::isnan(v) && std::isnan(mv))) return MISSING_VAL;
+        vel[i] = v;
+    }
+    return 0;
+}
+
+bool GridField::InsideVolumeVelocity(double time, glm::vec3 pos) const
+{
+    const VAPoR::CoordType coords{pos.x, pos.y, pos.z};
+    size_t                 floor = 0;
+    if (!_locateTimestep(time, floor)) return false;
+
+    if (!_insideAtTimestep(floor, coords)) return false;
+    if (!IsSteady && time > _timestamps[floor]) return _insideAtTimestep(floor + 1, coords);
+    return true;
+}
+
+int GridField::GetVelocity(double time, glm::vec3 pos, glm::vec3 &vel) const
+{
+    const VAPoR::CoordType coords{pos.x, pos.y, pos.z};
+    if (_timestamps.empty()) return NO_FIELD_YET;
+
+    size_t floor = 0;
+    if (!_locateTimestep(time, floor)) return TIME_ERROR;
+
+    int rv = _getVelocityAtTimestep(floor, coords, vel);
+    if (rv != 0 || IsSteady || time == _timestamps[floor]) return rv;
+
+    glm::vec3 ceilVel;
+    rv = _getVelocityAtTimestep(floor + 1, coords, ceilVel);
+    if (rv != 0) return rv;
+
+    const float weight = float((time - _timestamps[floor]) / (_timestamps[floor + 1] - _timestamps[floor]));
+    vel = glm::mix(vel, ceilVel, weight);
+    return 0;
+}
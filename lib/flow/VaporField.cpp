@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "vapor/VaporField.h"
 #include "vapor/ConstantGrid.h"
 
@@ -62,6 +63,16 @@ auto VaporField::LockParams() -> int
     _c_vel_mult = _params->GetVelocityMultiplier();
     _params->GetBox()->GetExtents(_c_ext_min, _c_ext_max);
 
+    // Velocity components defined on the same coordinate variables can
+    // share a single point location.
+    _c_vel_shared_coords = std::none_of(VelocityNames.cbegin(), VelocityNames.cend(), [](const std::string &v) { return v.empty(); });
+    if (_c_vel_shared_coords) {
+        auto coordVars = _datamgr->GetVarCoordVars(VelocityNames[0], true);
+        for (int i = 1; i < 3; i++) {
+            if (_datamgr->GetVarCoordVars(VelocityNames[i], true) != coordVars) _c_vel_shared_coords = false;
+        }
+    }
+
     _params_locked = true;
     return 0;
 }
@@ -74,6 +85,7 @@ auto VaporField::UnlockParams() -> int
     _c_vel_mult = 0.0;
     _c_ext_min = {0.0, 0.0, 0.0};
     _c_ext_max = {0.0, 0.0, 0.0};
+    _c_vel_shared_coords = false;
 
     _params_locked = false;
     return 0;
@@ -206,23 +218,17 @@ int VaporField::GetVelocityIntersection(size_t ts, glm::vec3 &minxyz, glm::vec3
 int VaporField::GetVelocity(double time, glm::vec3 pos, glm::vec3 &velocity) const
 {
     VAPoR::CoordType            coords{pos.x, pos.y, pos.z};
-    const VAPoR::Grid *         grid = nullptr;
 
     // Retrieve the missing value and velocity multiplier
     glm::vec3 missingV(0.0f);    // stores missing values for 3 velocity variables
     velocity = glm::vec3(0.0f);
 
     if (IsSteady) {
-        for (int i = 0; i < 3; i++) {
-            auto currentTS = _c_currentTS;
-            if (!_params_locked)
-                currentTS = _params->GetCurrentTimestep();
-            grid = _getAGrid(currentTS, VelocityNames[i]);
-            if (grid == nullptr) return GRID_ERROR;
-
-            velocity[i] = grid->GetValue(coords);
-            missingV[i] = grid->GetMissingValue();
-        }
+        auto currentTS = _c_currentTS;
+        if (!_params_locked)
+            currentTS = _params->GetCurrentTimestep();
+        int rv = _getVelocityAtTimestep(currentTS, coords, velocity, missingV);
+        if (rv != 0) return rv;
         auto  hasMissing = glm::equal(velocity, missingV);
         // If missing values are represented using NaN, you cannot compare equality with them!
         for (int i = 0; i < 3; i++) {
@@ -250,13 +256,8 @@ int VaporField::GetVelocity(double time, glm::vec3 pos, glm::vec3 &velocity) con
         // Find the velocity values at floor time step
         glm::vec3 floorVelocity(0.f, 0.f, 0.f);
         glm::vec3 ceilingVelocity(0.f, 0.f, 0.f);
-        for (int i = 0; i < 3; i++) {
-            grid = _getAGrid(floorTS, VelocityNames[i]);
-            if (grid == nullptr) return GRID_ERROR;
-
-            floorVelocity[i] = grid->GetValue(coords);
-            missingV[i] = grid->GetMissingValue();
-        }
+        rv = _getVelocityAtTimestep(floorTS, coords, floorVelocity, missingV);
+        if (rv != 0) return rv;
         auto hasMissing = glm::equal(floorVelocity, missingV);
         if (glm::any(hasMissing)) { return MISSING_VAL; }
 
@@ -268,12 +269,8 @@ int VaporField::GetVelocity(double time, glm::vec3 pos, glm::vec3 &velocity) con
         else {  // Find the velocity values at the ceiling time step, then interpolate.
             // We need to make sure there aren't duplicate time stamps
             VAssert(_timestamps[floorTS + 1] > _timestamps[floorTS]);
-            for (int i = 0; i < 3; i++) {
-                grid = _getAGrid(floorTS + 1, VelocityNames[i]);
-                if (grid == nullptr) return GRID_ERROR;
-                ceilingVelocity[i] = grid->GetValue(coords);
-                missingV[i] = grid->GetMissingValue();
-            }
+            rv = _getVelocityAtTimestep(floorTS + 1, coords, ceilingVelocity, missingV);
+            if (rv != 0) return rv;
             hasMissing = glm::equal(ceilingVelocity, missingV);
             if (glm::any(hasMissing)) { return MISSING_VAL; }
 
@@ -342,6 +339,34 @@ int VaporField::GetScalar(double time, glm::vec3 pos, float &scalar) const
     }    // end of unsteady condition
 }
 
+int VaporField::_getVelocityAtTimestep(uint32_t timestep, const VAPoR::CoordType &coords, glm::vec3 &velocity, glm::vec3 &missingV) const
+{
+    const VAPoR::Grid *grids[3];
+    for (int i = 0; i < 3; i++) {
+        grids[i] = _getAGrid(timestep, VelocityNames[i]);
+        if (grids[i] == nullptr) return GRID_ERROR;
+        missingV[i] = grids[i]->GetMissingValue();
+    }
+
+    // The component grids share coordinate variables, and were retrieved
+    // with the same refinement level and extents. Unless their node
+    // layouts still differ, locate the point once and reuse the location.
+    bool shareLocation = _params_locked && _c_vel_shared_coords;
+    for (int i = 1; i < 3 && shareLocation; i++) {
+        shareLocation = grids[i]->GetNodeDimensions() == grids[0]->GetNodeDimensions() && grids[i]->GetMinAbs() == grids[0]->GetMinAbs();
+    }
+
+    if (shareLocation) {
+        VAPoR::Grid::PointLocation loc;
+        grids[0]->LocatePoint(coords, loc);
+        for (int i = 0; i < 3; i++) velocity[i] = grids[i]->GetValueAtLocation(loc);
+    } else {
+        for (int i = 0; i < 3; i++) velocity[i] = grids[i]->GetValue(coords);
+    }
+
+    return 0;
+}
+
 bool VaporField::_isReady() const
 {
     if (!_datamgr) return false;
@@ -352,6 +377,8 @@ bool VaporField::_isReady() const
 
 void VaporField::AssignDataManager(VAPoR::DataMgr *dmgr)
 {
+    // Pinned grids belong to the previous data manager
+    if (_datamgr) _releasePinnedGrids();
     _datamgr = dmgr;
 
     // Make a copy of the timestamps from the new data manager
@@ -387,6 +414,104 @@ int VaporField::LocateTimestamp(double time, size_t &floor) const
 
 uint32_t VaporField::GetNumberOfTimesteps() const { return _timestamps.size(); }
 
+std::vector<double> VaporField::GetTimestamps() const { return _timestamps; }
+
+int VaporField::PrepareTimeWindow(double t0, double t1, bool prefetchNext) const
+{
+    VAssert(_isReady());
+    if (_timestamps.empty()) return 0;
+
+    std::vector<std::string> varnames;
+    for (const auto &v : VelocityNames) {
+        if (std::find(varnames.cbegin(), varnames.cend(), v) == varnames.cend()) varnames.push_back(v);
+    }
+    if (!ScalarName.empty()) varnames.push_back(ScalarName);
+
+    // A steady field only ever reads the current time step. Bring its grids into
+    // the cache, and have them compute their lazily evaluated extents, so
+    // concurrent queries never modify either.
+    if (IsSteady) {
+        auto currentTS = _params_locked ? _c_currentTS : _params->GetCurrentTimestep();
+        for (const auto &v : varnames) {
+            const auto *grid = _getAGrid(currentTS, v);
+            if (grid == nullptr) return GRID_ERROR;
+            VAPoR::CoordType minu, maxu;
+            grid->GetUserExtents(minu, maxu);
+        }
+        return 0;
+    }
+
+    // Find the time steps bracketing the window
+    t0 = glm::clamp(t0, _timestamps.front(), _timestamps.back());
+    t1 = glm::clamp(t1, _timestamps.front(), _timestamps.back());
+    size_t first = 0, last = 0;
+    if (LocateTimestamp(t0, first) != 0 || LocateTimestamp(t1, last) != 0) return TIME_ERROR;
+    if (t1 > _timestamps[last]) last++;
+
+    // Slide the window of pinned grids: take in what has been loading in the
+    // background, and unpin the time steps before the bracket.
+    int rv = _finishPrefetch();
+    if (rv != 0) return rv;
+    _releasePinnedGrids(first, last + 1);
+
+    auto isPinned = [this](const GridKey &key) {
+        return std::any_of(_pinnedGrids.cbegin(), _pinnedGrids.cend(), [&key](const PinnedGrid &p) { return p.key == key; });
+    };
+
+    // Pin the grids of the bracket, loading the ones not loaded ahead of time.
+    // Like above, their extents are computed before any concurrent query.
+    for (size_t ts = first; ts <= last; ts++) {
+        for (const auto &v : varnames) {
+            const auto request = _makeRequest(ts, v);
+            const auto key = request.key();
+            if (isPinned(key)) continue;
+
+            const std::lock_guard<std::mutex> lock_gd(_grid_operation_mutex);
+            auto *grid = _loadGrid(request);
+            if (grid == nullptr) return GRID_ERROR;
+            VAPoR::CoordType minu, maxu;
+            grid->GetUserExtents(minu, maxu);
+            _pinnedGrids.push_back(PinnedGrid{key, request.timestep, std::unique_ptr<GridWrapper>(new GridWrapper(grid, _datamgr))});
+        }
+    }
+
+    // Start loading the time step after the bracket, so it's ready by the
+    // time the particles get there. Not after the caller's last window though:
+    // FinishTimeWindows() would wait for a load nobody needs.
+    // Variables missing from that time step are left for the synchronous load
+    // to report.
+    if (prefetchNext && last + 1 < _timestamps.size()) {
+        std::vector<GridRequest> requests;
+        for (const auto &v : varnames) {
+            auto request = _makeRequest(last + 1, v);
+            if (isPinned(request.key())) continue;
+            if (!request.varName.empty() && !_datamgr->VariableExists(request.timestep, request.varName, request.refLev, request.compLev)) continue;
+            requests.push_back(request);
+        }
+
+        // The loading thread must not report errors itself: the error is kept,
+        // and reported by _finishPrefetch() on the calling thread.
+        if (!requests.empty()) {
+            _prefetch = std::async(std::launch::async, [this, requests]() {
+                Prefetched                        result;
+                const std::lock_guard<std::mutex> lock_gd(_grid_operation_mutex);
+                for (const auto &request : requests) {
+                    auto *grid = _loadGrid(request, result.error);
+                    if (grid == nullptr) break;
+                    VAPoR::CoordType minu, maxu;
+                    grid->GetUserExtents(minu, maxu);
+                    result.grids.push_back(PinnedGrid{request.key(), request.timestep, std::unique_ptr<GridWrapper>(new GridWrapper(grid, _datamgr))});
+                }
+                return result;
+            });
+        }
+    }
+
+    return 0;
+}
+
+void VaporField::FinishTimeWindows() const { (void)_finishPrefetch(); }
+
 int VaporField::CalcDeltaTFromCurrentTimeStep(double &delT) const
 {
     VAssert(_isReady());
@@ -497,74 +622,139 @@ int VaporField::CalcDeltaTFromCurrentTimeStep(double &delT) const
 
 const VAPoR::Grid *VaporField::_getAGrid(uint32_t timestep, const std::string &varName) const
 {
-    GridKey key;
-    if (_params_locked) {
-        // Because in unsteady case, both currentTS and currentTS + 1 will be queried,
-        // so we do a sanity check here. The assertion will be gone in release mode.
-        assert(timestep == _c_currentTS);
-        key.Reset(_c_currentTS, _c_refLev, _c_compLev, varName, _c_ext_min, _c_ext_max);
-    } else {
-        VAPoR::CoordType extMin, extMax;
-        _params->GetBox()->GetExtents(extMin, extMax);
-        int refLevel = _params->GetRefinementLevel();
-        int compLevel = _params->GetCompressionLevel();
-        key.Reset(timestep, refLevel, compLevel, varName, extMin, extMax);
+    const GridRequest request = _makeRequest(timestep, varName);
+    const GridKey     key = request.key();
+
+    // Grids pinned by PrepareTimeWindow() don't change while queries are
+    // running, so they are looked up without locking.
+    for (const auto &p : _pinnedGrids) {
+        if (p.key == key) return p.wrapper->grid();
     }
 
-    // First check if we have the requested grid in our cache.
+    // Then check if we have the requested grid in our cache.
     // If it exists, return the grid directly.
     const auto* wrapper = _recentGrids.query(key);
     if (wrapper != nullptr) { return wrapper->grid(); }
 
     // There's no such grid in our cache!
-    // Let's create a new grid by doing one of the two things, and then put it in the cache.
-    // 1) create it by ourselves if a ConstantGrid is required, or
-    // 2) ask for it from the data manager,
-    //
+    // Let's create a new grid, and then put it in the cache.
 
     // Note that we use a lock here, so no two threads querying _datamgr simultaneously.
     const std::lock_guard<std::mutex> lock_gd(_grid_operation_mutex);
 
+    // Another thread may have created the grid while we waited for the lock.
+    wrapper = _recentGrids.query(key);
+    if (wrapper != nullptr) { return wrapper->grid(); }
+
+    VAPoR::Grid *grid = _loadGrid(request);
+    if (grid == nullptr) return nullptr;
+
+    // Now we have this grid, but also put it in a GridWrapper so
+    // 1) it will be properly deleted, and
+    // 2) it is stored in our cache, where its ownership is kept.
+    _recentGrids.insert(key, new GridWrapper(grid, _datamgr));
+    return grid;
+}
+
+auto VaporField::_makeRequest(uint32_t timestep, const std::string &varName) const -> GridRequest
+{
+    GridRequest request;
+    request.varName = varName;
+    if (_params_locked) {
+        // Because in unsteady case, both currentTS and currentTS + 1 will be queried,
+        // so we do a sanity check here. The assertion will be gone in release mode.
+        assert(timestep == _c_currentTS);
+        request.timestep = _c_currentTS;
+        request.refLev = _c_refLev;
+        request.compLev = _c_compLev;
+        request.extMin = _c_ext_min;
+        request.extMax = _c_ext_max;
+    } else {
+        request.timestep = timestep;
+        request.refLev = _params->GetRefinementLevel();
+        request.compLev = _params->GetCompressionLevel();
+        _params->GetBox()->GetExtents(request.extMin, request.extMax);
+    }
+    return request;
+}
+
+GridKey VaporField::GridRequest::key() const
+{
+    GridKey key;
+    key.Reset(timestep, refLev, compLev, varName, extMin, extMax);
+    return key;
+}
+
+VAPoR::Grid *VaporField::_loadGrid(const GridRequest &request) const
+{
+    std::string  error;
+    VAPoR::Grid *grid = _loadGrid(request, error);
+    if (grid == nullptr) Wasp::MyBase::SetErrMsg("%s", error.c_str());
+    return grid;
+}
+
+VAPoR::Grid *VaporField::_loadGrid(const GridRequest &request, std::string &error) const
+{
+    // Create a new grid by doing one of the two things:
+    // 1) create it by ourselves if a ConstantGrid is required, or
+    // 2) ask for it from the data manager.
     VAPoR::Grid *grid = nullptr;
-    if (key.emptyVar()) {
+    if (request.varName.empty()) {
         // In case of an empty variable name, we generate a constantGrid with zeros.
         grid = new VAPoR::ConstantGrid(0.0f, 3);
     } 
     else {
-        if (_params_locked) {
-            grid = _datamgr->GetVariable(_c_currentTS, varName, _c_refLev, _c_compLev, 
-                                         _c_ext_min, _c_ext_max, true);
-        } 
-        else {
-            VAPoR::CoordType extMin, extMax;
-            _params->GetBox()->GetExtents(extMin, extMax);
-            int refLevel = _params->GetRefinementLevel();
-            int compLevel = _params->GetCompressionLevel();
-            grid = _datamgr->GetVariable(timestep, varName, refLevel, compLevel, extMin, extMax, true);
-        }
+        grid = _datamgr->GetVariable(request.timestep, request.varName, request.refLev, request.compLev, 
+                                     request.extMin, request.extMax, true);
     }
 
     if (grid == nullptr) {
-        Wasp::MyBase::SetErrMsg("Not able to get a grid!");
+        error = "Not able to get a grid!";
         return nullptr;
     }
 
-    // Now we have this grid, but also put it in a GridWrapper so
-    // 1) it will be properly deleted, and
-    // 2) it is stored in our cache, where its ownership is kept.
-    auto dim = _datamgr->GetVarTopologyDim(varName);
+    auto dim = _datamgr->GetVarTopologyDim(request.varName);
 
     if (dim == 1) {
-        Wasp::MyBase::SetErrMsg("Variable Dimension Wrong!");
+        error = "Variable Dimension Wrong!";
         return nullptr;
     }
-    _recentGrids.insert(key, new GridWrapper(grid, _datamgr));
     return grid;
 }
 
+int VaporField::_finishPrefetch() const
+{
+    if (!_prefetch.valid()) return 0;
+
+    auto result = _prefetch.get();
+    for (auto &g : result.grids) _pinnedGrids.push_back(std::move(g));
+    if (!result.error.empty()) {
+        Wasp::MyBase::SetErrMsg("%s", result.error.c_str());
+        return GRID_ERROR;
+    }
+    return 0;
+}
+
+void VaporField::_releasePinnedGrids() const
+{
+    (void)_finishPrefetch();
+
+    // Destroying a GridWrapper talks to the data manager
+    const std::lock_guard<std::mutex> lock_gd(_grid_operation_mutex);
+    _pinnedGrids.clear();
+}
+
+void VaporField::_releasePinnedGrids(size_t first, size_t last) const
+{
+    const std::lock_guard<std::mutex> lock_gd(_grid_operation_mutex);
+    auto outside = [first, last](const PinnedGrid &p) { return p.timestep < first || p.timestep > last; };
+    _pinnedGrids.erase(std::remove_if(_pinnedGrids.begin(), _pinnedGrids.end(), outside), _pinnedGrids.end());
+}
 
 void VaporField::ReleaseLockedGrids()
 {
+    _releasePinnedGrids();
+
     // Release locked grids by giving the cache a bunch of nullptrs with unique invalid keys.
     GridKey key;
     for (int i = 0; i < _recentGrids.size(); i++) {
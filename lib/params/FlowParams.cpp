@@ -19,6 +19,8 @@ const std::string FlowParams::RenderFadeTailTag = "RenderFadeTailTag";
 const std::string FlowParams::RenderFadeTailStartTag = "RenderFadeTailStartTag";
 const std::string FlowParams::RenderFadeTailStopTag = "RenderFadeTailStopTag";
 const std::string FlowParams::RenderFadeTailLengthTag = "RenderFadeTailLengthTag";
+const std::string FlowParams::RenderSimplifyToleranceTag = "RenderSimplifyToleranceTag";
+const std::string FlowParams::ColorSampleStrideTag = "ColorSampleStrideTag";
 const std::string FlowParams::PhongAmbientTag = "PhongAmbientTag";
 const std::string FlowParams::PhongDiffuseTag = "PhongDiffuseTag";
 const std::string FlowParams::PhongSpecularTag = "PhongSpecularTag";
@@ -80,6 +82,9 @@ FlowParams::FlowParams(DataMgr *dataManager, ParamsBase::StateSave *stateSave) :
     SetValueLong(RenderFadeTailLengthTag, "", 10);
     SetValueLong(RenderFadeTailStopTag, "", 0);
 
+    SetValueDouble(RenderSimplifyToleranceTag, "", 0);
+    SetValueLong(ColorSampleStrideTag, "", 1);
+
     SetValueDouble(PhongAmbientTag, "", 0.4);
     SetValueDouble(PhongDiffuseTag, "", 0.8);
     SetValueDouble(PhongSpecularTag, "", 0);
@@ -16,6 +16,7 @@ const std::string ParticleParams::RenderRadiusScalarTag = "RenderRadiusScalarTag
 PARAMS_IMPL_TAG(ParticleParams, RenderRadiusVariableTag);
 PARAMS_IMPL_TAG(ParticleParams, RenderRadiusVariableStrengthTag);
 PARAMS_IMPL_TAG(ParticleParams, RecalculateRadiusBaseRequestTag);
+PARAMS_IMPL_TAG(ParticleParams, MaxParticlesTag);
 const std::string ParticleParams::LightingEnabledTag = "LightingEnabledTag";
 const std::string ParticleParams::RenderRadiusBaseTag = "RenderRadiusBaseTag";
 const std::string ParticleParams::RenderLegacyTag = "RenderLegacyTag";
@@ -49,6 +50,7 @@ void ParticleParams::_init()
     SetValueLong(ShowDirectionTag, "", false);
     SetValueDouble(DirectionScaleTag, "", 1);
     SetValueLong(StrideTag, "", 1);
+    SetValueLong(MaxParticlesTag, "", 0);
     SetValueDouble(RenderRadiusScalarTag, "", 8.);
     SetValueDouble(RenderRadiusVariableStrengthTag, "", 1.);
     SetValueDouble(RenderRadiusBaseTag, "", -1);
@@ -31,6 +31,7 @@
 #include <cstdio>
 #include <cstring>
 #include <limits>
+#include <algorithm>
 
 #ifndef WIN32
     #include <unistd.h>
@@ -51,6 +52,7 @@
 #include "vapor/LegacyGL.h"
 #include "vapor/GLManager.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <vapor/OpenMPSupport.h>
 
 #define X    0
 #define Y    1
@@ -213,7 +215,13 @@ int BarbRenderer::_paintGL(bool)
     float clut[1024];
     bool  doColorMapping = _makeCLUT(clut);
     auto  crange = GetActiveParams()->GetMapperFunc(GetActiveParams()->GetColorMapVariableName())->getMinMaxMapValue();
-    for (auto b : _barbCache) _drawBarb(b, doColorMapping, clut, crange.data());
+
+    BarbParams *bParams = dynamic_cast<BarbParams *>(GetActiveParams());
+    VAssert(bParams);
+    vector<double> scales = _getScales();
+    float          radius = bParams->GetLineThickness() * _maxThickness;
+    float          lengthScalar = bParams->GetLengthScale() * _vectorScaleFactor;
+    for (auto b : _barbCache) _drawBarb(b, doColorMapping, clut, crange.data(), scales, radius, lengthScalar);
 
     _glManager->legacy->DisableLighting();
 
@@ -352,24 +360,6 @@ void BarbRenderer::_printBackDiameter(const float startVertex[18]) const
 }
 #endif
 
-// Issue OpenGL calls to draw a cylinder with orthogonal ends from
-// one point to another.  Then put an barb head on the end
-//
-void BarbRenderer::_drawBarb(const std::vector<Grid *> variableData, const float startPoint_[3], bool doColorMapping, const float clut[1024])
-{
-    Barb b;
-    memcpy(b.startPoint, startPoint_, sizeof(float) * 3);
-    b.lengthScalar = ((BarbParams *)GetActiveParams())->GetLengthScale() * _vectorScaleFactor;
-
-    VAssert(variableData.size() == 5);
-
-    bool missing = _defineBarb(variableData, b.startPoint, b.endPoint, &b.value, doColorMapping, clut);
-
-    if (missing) return;
-
-    _barbCache.push_back(b);
-}
-
 void BarbRenderer::_setBarbColor(float value, const float clut[1024], double crange[2]) const
 {
     float range = crange[1] - crange[0];
@@ -380,13 +370,15 @@ void BarbRenderer::_setBarbColor(float value, const float clut[1024], double cra
     _glManager->legacy->Color4fv(&clut[i * 4]);
 }
 
-void BarbRenderer::_drawBarb(Barb b, bool doColorMapping, const float clut[1024], double crange[2])
+// Issue OpenGL calls to draw a cylinder with orthogonal ends from
+// one point to another.  Then put an barb head on the end
+//
+void BarbRenderer::_drawBarb(Barb b, bool doColorMapping, const float clut[1024], double crange[2], const vector<double> &scales, float radius, float newLengthScalar)
 {
     float *        startPoint = b.startPoint;
     float *        endPoint = b.endPoint;
     MatrixManager *mm = _glManager->matrixManager;
     if (doColorMapping) _setBarbColor(b.value, clut, crange);
-    float     newLengthScalar = ((BarbParams *)GetActiveParams())->GetLengthScale() * _vectorScaleFactor;
     glm::vec3 v = glm::make_vec3(b.endPoint) - glm::make_vec3(b.startPoint);
     float     l = glm::length(v) / b.lengthScalar * newLengthScalar;
     glm::vec3 end = glm::make_vec3(b.startPoint) + glm::normalize(v) * l;
@@ -403,7 +395,6 @@ void BarbRenderer::_drawBarb(Barb b, bool doColorMapping, const float clut[1024]
 
     startPoint[0] = startPoint[1] = startPoint[2] = 0;
 
-    vector<double> scales = _getScales();
     mm->Scale(1.f / scales[0], 1.f / scales[1], 1.f / scales[2]);
 
     // Constants are needed for cosines and sines, at
@@ -442,11 +433,6 @@ void BarbRenderer::_drawBarb(Barb b, bool doColorMapping, const float clut[1024]
     vscale(uVec, 1.f / sqrt(len));
     vcross(uVec, dirVec, bVec);
 
-    BarbParams *bParams = dynamic_cast<BarbParams *>(GetActiveParams());
-    VAssert(bParams);
-
-    float radius = bParams->GetLineThickness() * _maxThickness;
-
     // calculate 6 points in plane orthog to dirVec, in plane of point
     for (int i = 0; i < 6; i++) {
         // testVec and testVec2 are components of point in plane
@@ -592,7 +578,7 @@ void BarbRenderer::_makeRakeGrid(vector<int> &rakeGrid) const
     rakeGrid.push_back((int)longGrid[Z]);
 }
 
-float BarbRenderer::_getHeightOffset(Grid *heightVar, float xCoord, float yCoord, bool &missing) const
+float BarbRenderer::_getHeightOffset(const Grid *heightVar, float xCoord, float yCoord, float defaultZ, bool &missing) const
 {
     VAssert(heightVar);
     float missingVal = heightVar->GetMissingValue();
@@ -601,12 +587,11 @@ float BarbRenderer::_getHeightOffset(Grid *heightVar, float xCoord, float yCoord
         missing = true;
         offset = 0.f;
     }
-    BarbParams* p = (BarbParams *)GetActiveParams();
-    offset -= GetDefaultZ(_dataMgr, p->GetCurrentTimestep());
+    offset -= defaultZ;
     return offset;
 }
 
-void BarbRenderer::_getDirection(float direction[3], vector<Grid *> variableData, float xCoord, float yCoord, float zCoord, bool &missing) const
+void BarbRenderer::_getDirection(float direction[3], const vector<Grid *> &variableData, float xCoord, float yCoord, float zCoord, bool &missing) const
 {
     for (int dim = 0; dim < 3; dim++) {
         direction[dim] = 0.f;
@@ -662,14 +647,8 @@ float BarbRenderer::_calculateLength(float start[3], float end[3]) const
     return length;
 }
 
-void BarbRenderer::_makeStartAndEndPoint(float start[3], float end[3], float direction[3])
+void BarbRenderer::_makeStartAndEndPoint(const float start[3], float end[3], const float direction[3], const vector<double> &scales, float length) const
 {
-    BarbParams *bParams = dynamic_cast<BarbParams *>(GetActiveParams());
-    VAssert(bParams);
-    float length = bParams->GetLengthScale() * _vectorScaleFactor;
-
-    vector<double> scales = _getScales();
-
     end[X] = start[X] + scales[X] * direction[X] * length;
     end[Y] = start[Y] + scales[Y] * direction[Y] * length;
     end[Z] = start[Z] + scales[Z] * direction[Z] * length;
@@ -689,32 +668,33 @@ void BarbRenderer::_getStrides(vector<float> &strides, vector<int> &rakeGrid, ve
     strides.push_back(zStride);
 }
 
-bool BarbRenderer::_defineBarb(const std::vector<Grid *> variableData, float start[3], float end[3], float *value, bool doColorMapping, const float clut[1024])
+bool BarbRenderer::_defineBarb(const std::vector<Grid *> &variableData, float start[3], float end[3], float *value, bool doColorMapping, const vector<double> &scales, float length,
+                               float defaultZ) const
 {
     bool missing = false;
 
     Grid *heightVar = variableData[3];
-    if (heightVar) { start[Z] += _getHeightOffset(heightVar, start[X], start[Y], missing); }
+    if (heightVar) { start[Z] += _getHeightOffset(heightVar, start[X], start[Y], defaultZ, missing); }
 
     float direction[3] = {0.f, 0.f, 0.f};
     _getDirection(direction, variableData, start[X], start[Y], start[Z], missing);
 
-    _makeStartAndEndPoint(start, end, direction);
+    _makeStartAndEndPoint(start, end, direction, scales, length);
 
     if (doColorMapping) {
         float val = variableData[4]->GetValue(start[X], start[Y], start[Z]);
         *value = val;
 
-        if (val == variableData[4]->GetMissingValue())
-            missing = true;
-        else {
-            missing = _getColorMapping(val, clut);
-        }
+        if (val == variableData[4]->GetMissingValue()) missing = true;
     }
     return missing;
 }
 
-void BarbRenderer::_operateOnGrid(vector<Grid *> variableData, bool drawBarb)
+// Barbs are sampled independently, one rake point per iteration, in
+// parallel. Barb (i,j,k) is written to its own slot and the missing ones are
+// squeezed out afterwards, so _barbCache keeps the serial i,j,k order.
+//
+void BarbRenderer::_operateOnGrid(const vector<Grid *> &variableData, bool drawBarb)
 {
     vector<int> rakeGrid;
     _makeRakeGrid(rakeGrid);
@@ -728,29 +708,72 @@ void BarbRenderer::_operateOnGrid(vector<Grid *> variableData, bool drawBarb)
     float clut[1024];
     bool  doColorMapping = _makeCLUT(clut);
 
-    float start[3];
-    for (int i = 1; i <= rakeGrid[X]; i++) {
-        start[X] = strides[X] * i + rakeExts[X];    // + xStride/2.0;
-        for (int j = 1; j <= rakeGrid[Y]; j++) {
-            start[Y] = strides[Y] * j + rakeExts[Y];    // + yStride/2.0;
-            for (int k = 1; k <= rakeGrid[Z]; k++) {
-                start[Z] = strides[Z] * k + rakeExts[Z];    //+ zStride/2.0;
-
-                if (drawBarb) {
-                    _drawBarb(variableData, start, doColorMapping, clut);
-                } else {
-                    _getMagnitudeAtPoint(variableData, start);
-                }
+    const long nx = max(rakeGrid[X], 0);
+    const long ny = max(rakeGrid[Y], 0);
+    const long nz = max(rakeGrid[Z], 0);
+    const long nBarbs = nx * ny * nz;
+
+    // Grid caches its user extents lazily; fill the cache here so the
+    // parallel lookups below only ever read it.
+    //
+    for (auto g : variableData) {
+        if (!g) continue;
+        CoordType minu, maxu;
+        g->GetUserExtents(minu, maxu);
+    }
+
+    if (!drawBarb) {
+        double maxValue = _maxValue;
+#pragma omp parallel
+        {
+            double threadMax = 0.0;
+#pragma omp for
+            for (long index = 0; index < nBarbs; index++) {
+                float start[3];
+                start[X] = strides[X] * (index / (ny * nz) + 1) + rakeExts[X];
+                start[Y] = strides[Y] * (index / nz % ny + 1) + rakeExts[Y];
+                start[Z] = strides[Z] * (index % nz + 1) + rakeExts[Z];
+                threadMax = max(threadMax, _getMagnitudeAtPoint(variableData, start));
             }
+#pragma omp critical
+            maxValue = max(maxValue, threadMax);
         }
+        _maxValue = maxValue;
+        return;
+    }
+
+    BarbParams *bParams = dynamic_cast<BarbParams *>(GetActiveParams());
+    VAssert(bParams);
+    const vector<double> scales = _getScales();
+    const float          length = bParams->GetLengthScale() * _vectorScaleFactor;
+    const float          defaultZ = variableData[3] ? GetDefaultZ(_dataMgr, bParams->GetCurrentTimestep()) : 0.f;
+
+    vector<Barb>          barbs(nBarbs);
+    vector<unsigned char> valid(nBarbs);
+
+#pragma omp parallel for
+    for (long index = 0; index < nBarbs; index++) {
+        Barb &b = barbs[index];
+        b.startPoint[X] = strides[X] * (index / (ny * nz) + 1) + rakeExts[X];
+        b.startPoint[Y] = strides[Y] * (index / nz % ny + 1) + rakeExts[Y];
+        b.startPoint[Z] = strides[Z] * (index % nz + 1) + rakeExts[Z];
+        b.lengthScalar = length;
+        b.value = 0.f;
+
+        valid[index] = !_defineBarb(variableData, b.startPoint, b.endPoint, &b.value, doColorMapping, scales, length, defaultZ);
+    }
+
+    _barbCache.clear();
+    _barbCache.reserve(nBarbs);
+    for (long index = 0; index < nBarbs; index++) {
+        if (valid[index]) _barbCache.push_back(barbs[index]);
     }
-    return;
 }
 
-void BarbRenderer::_getMagnitudeAtPoint(std::vector<VAPoR::Grid *> variables, float point[3])
+double BarbRenderer::_getMagnitudeAtPoint(const std::vector<VAPoR::Grid *> &variables, const float point[3]) const
 {
-    VAPoR::Grid *grid;
-    double       maxValue = 0.f;
+    const VAPoR::Grid *grid;
+    double             maxValue = 0.f;
     for (int i = 0; i < 3; i++) {
         grid = variables[i];
         if (grid == NULL)
@@ -765,26 +788,7 @@ void BarbRenderer::_getMagnitudeAtPoint(std::vector<VAPoR::Grid *> variables, fl
             if (value > maxValue && value < std::numeric_limits<double>::max() && value > std::numeric_limits<double>::lowest() && !std::isnan(value)) maxValue = value;
         }
     }
-    if (maxValue > _maxValue) { _maxValue = maxValue; }
-}
-
-bool BarbRenderer::_getColorMapping(float val, const float clut[256 * 4])
-{
-    bool missing = false;
-
-    MapperFunction *tf = 0;
-    BarbParams *    bParams = dynamic_cast<BarbParams *>(GetActiveParams());
-    VAssert(bParams);
-    string colorVar = bParams->GetColorMapVariableName();
-    tf = (MapperFunction *)bParams->GetMapperFunc(colorVar);
-    VAssert(tf);
-
-    float mappedColor[4] = {0., 0., 0., 0.};
-    // Use the transfer function to map the data:
-    int lutIndex = tf->mapFloatToIndex(val);
-    for (int i = 0; i < 4; i++) mappedColor[i] = clut[4 * lutIndex + i];
-    _glManager->legacy->Color4fv(mappedColor);
-    return missing;
+    return maxValue;
 }
 
 double BarbRenderer::_getDomainHypotenuse(size_t ts) const
@@ -21,6 +21,8 @@
 #include <sstream>
 #include <string>
 #include <iterator>
+#include <limits>
+#include <algorithm>
 
 #include <vapor/glutil.h>    // Must be included first!!!
 
@@ -38,6 +40,9 @@
 #include <vapor/GLManager.h>
 #include <vapor/LegacyGL.h>
 #include <vapor/ArbitrarilyOrientedRegularGrid.h>
+#include <vapor/StructuredGrid.h>
+#include <vapor/OpenMPSupport.h>
+#include <vapor/utils.h>
 
 using namespace VAPoR;
 
@@ -51,7 +56,7 @@ struct ContourRenderer::VertexData {
 static RendererRegistrar<ContourRenderer> registrar(ContourRenderer::GetClassType(), ContourParams::GetClassType());
 
 ContourRenderer::ContourRenderer(const ParamsMgr *pm, string winName, string dataSetName, string instName, DataMgr *dataMgr)
-: Renderer(pm, winName, dataSetName, ContourParams::GetClassType(), ContourRenderer::GetClassType(), instName, dataMgr), _VAO(0), _VBO(0), _nVertices(0)
+: Renderer(pm, winName, dataSetName, ContourParams::GetClassType(), ContourRenderer::GetClassType(), instName, dataMgr), _VAO(0), _VBO(0), _nVertices(0), _bufferCapacity(0), _bufferUsed(0)
 {
 }
 
@@ -72,7 +77,6 @@ void ContourRenderer::_saveCacheParams()
     _cacheParams.lod = p->GetCompressionLevel();
     _cacheParams.lineThickness = p->GetLineThickness();
     p->GetBox()->GetExtents(_cacheParams.boxMin, _cacheParams.boxMax);
-    _cacheParams.contourValues = p->GetContourValues(_cacheParams.varName);
     _cacheParams.sliceRotation = p->GetSlicePlaneRotation();
     _cacheParams.sliceNormal = p->GetSlicePlaneNormal();
     _cacheParams.sliceOrigin = p->GetSlicePlaneOrigin();
@@ -97,13 +101,11 @@ bool ContourRenderer::_isCacheDirty() const
     if (_cacheParams.sliceResolution != p->GetValueDouble(RenderParams::SampleRateTag, 200)) return true;
     if (_cacheParams.sliceOrientationMode != p->GetValueLong(RenderParams::SlicePlaneOrientationModeTag, 0)) return true;
 
-    vector<double> min, max, contourValues;
+    vector<double> min, max;
     p->GetBox()->GetExtents(min, max);
-    contourValues = p->GetContourValues(_cacheParams.varName);
 
     if (_cacheParams.boxMin != min) return true;
     if (_cacheParams.boxMax != max) return true;
-    if (_cacheParams.contourValues != contourValues) return true;
 
     return false;
 }
@@ -130,18 +132,258 @@ static vector<double> ToDoubleVec(const glm::vec3 &v)
 }
 
 
+namespace {
+// Number of consecutive cells summarized by a single entry of the
+// block value range index when the grid's own data blocks can't be used
+//
+const size_t cellsPerBlock = 256;
+}    // namespace
+
+void ContourRenderer::_buildCellIndex(const Grid *grid, const Grid *heightGrid, const vector<float> &gridBlockMins, const vector<float> &gridBlockMaxs, const CoordType &boxMin,
+                                      const CoordType &boxMax, bool is2D, float defaultZ)
+{
+    double   mv = grid->GetMissingValue();
+    DimsType dims = grid->GetDimensions();
+    size_t   nNodes = Wasp::VProduct(dims.data(), dims.size());
+
+    // Nodes are shared by neighboring cells. Only fetch each of them once
+    //
+    vector<size_t> nodeSlot(nNodes, std::numeric_limits<size_t>::max());
+
+    size_t           maxNodes = grid->GetMaxVertexPerCell();
+    vector<DimsType> nodes(maxNodes);
+    vector<size_t>   slots(maxNodes);
+
+    // Append a cell to the index unless one of its nodes is missing.
+    // Returns false for skipped cells
+    //
+    auto addCell = [&](const DimsType &cell, float &cellMin, float &cellMax) {
+        grid->GetCellNodes(cell, nodes);
+
+        cellMin = std::numeric_limits<float>::max();
+        cellMax = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < nodes.size(); i++) {
+            size_t l = nodes[i][0] + dims[0] * (nodes[i][1] + dims[1] * nodes[i][2]);
+            if (nodeSlot[l] == std::numeric_limits<size_t>::max()) {
+                CoordType coords;
+                grid->GetUserCoordinates(nodes[i], coords);
+                float z = coords[2];
+                if (is2D) z = defaultZ;
+                if (heightGrid) z = heightGrid->GetValueAtIndex(nodes[i]);
+
+                nodeSlot[l] = _cellIndex.nodes.size() / 4;
+                _cellIndex.nodes.push_back(coords[0]);
+                _cellIndex.nodes.push_back(coords[1]);
+                _cellIndex.nodes.push_back(z);
+                _cellIndex.nodes.push_back(grid->GetValueAtIndex(nodes[i]));
+            }
+            slots[i] = nodeSlot[l];
+
+            float v = _cellIndex.nodes[slots[i] * 4 + 3];
+            if (v == mv) return (false);
+            cellMin = std::min(cellMin, v);
+            cellMax = std::max(cellMax, v);
+        }
+
+        _cellIndex.cellNodes.insert(_cellIndex.cellNodes.end(), slots.begin(), slots.begin() + nodes.size());
+        _cellIndex.cellStart.push_back(_cellIndex.cellNodes.size());
+        return (true);
+    };
+
+    _cellIndex.cellStart.push_back(0);
+    _cellIndex.blockStart.push_back(0);
+
+    const vector<size_t> &bdims = grid->GetDimensionInBlks();
+    const vector<size_t> &bs = grid->GetBlockSize();
+    size_t                nGridBlocks = bdims.size() ? Wasp::VProduct(bdims.data(), bdims.size()) : 0;
+
+    float cellMin, cellMax;
+    if (dynamic_cast<const StructuredGrid *>(grid) && nGridBlocks > 1 && gridBlockMins.size() == nGridBlocks && gridBlockMaxs.size() == nGridBlocks) {
+        // Visit the cells one data block at a time so that the block
+        // value ranges computed with the data apply to each run of cells
+        //
+        DimsType cdims = grid->GetCellDimensions();
+        DimsType bs3 = {1, 1, 1}, bdims3 = {1, 1, 1};
+        for (int i = 0; i < bs.size() && i < 3; i++) {
+            bs3[i] = bs[i];
+            bdims3[i] = bdims[i];
+        }
+
+        DimsType cell;
+        for (size_t b = 0; b < nGridBlocks; b++) {
+            DimsType bcoord = {b % bdims3[0], (b / bdims3[0]) % bdims3[1], b / (bdims3[0] * bdims3[1])};
+            DimsType c0, c1;
+            for (int i = 0; i < 3; i++) {
+                c0[i] = bcoord[i] * bs3[i];
+                c1[i] = std::min((bcoord[i] + 1) * bs3[i], cdims[i]);
+            }
+
+            for (cell[2] = c0[2]; cell[2] < c1[2]; cell[2]++)
+                for (cell[1] = c0[1]; cell[1] < c1[1]; cell[1]++)
+                    for (cell[0] = c0[0]; cell[0] < c1[0]; cell[0]++) addCell(cell, cellMin, cellMax);
+
+            if (_cellIndex.cellStart.size() - 1 == _cellIndex.blockStart.back()) continue;
+            _cellIndex.blockStart.push_back(_cellIndex.cellStart.size() - 1);
+            _cellIndex.blockMin.push_back(gridBlockMins[b]);
+            _cellIndex.blockMax.push_back(gridBlockMaxs[b]);
+        }
+        return;
+    }
+
+    float  blockMin = std::numeric_limits<float>::max();
+    float  blockMax = std::numeric_limits<float>::lowest();
+    size_t nCellsInBlock = 0;
+
+    Grid::ConstCellIterator it = grid->ConstCellBegin(boxMin, boxMax);
+    Grid::ConstCellIterator end = grid->ConstCellEnd();
+    for (; it != end; ++it) {
+        if (!addCell(*it, cellMin, cellMax)) continue;
+
+        blockMin = std::min(blockMin, cellMin);
+        blockMax = std::max(blockMax, cellMax);
+        if (++nCellsInBlock == cellsPerBlock) {
+            _cellIndex.blockStart.push_back(_cellIndex.cellStart.size() - 1);
+            _cellIndex.blockMin.push_back(blockMin);
+            _cellIndex.blockMax.push_back(blockMax);
+            blockMin = std::numeric_limits<float>::max();
+            blockMax = std::numeric_limits<float>::lowest();
+            nCellsInBlock = 0;
+        }
+    }
+    if (nCellsInBlock) {
+        _cellIndex.blockStart.push_back(_cellIndex.cellStart.size() - 1);
+        _cellIndex.blockMin.push_back(blockMin);
+        _cellIndex.blockMax.push_back(blockMax);
+    }
+}
+
+void ContourRenderer::_marchLevel(float contour, vector<float> &vertices) const
+{
+    const vector<float> & nodes = _cellIndex.nodes;
+    const vector<size_t> &cellNodes = _cellIndex.cellNodes;
+    const vector<size_t> &cellStart = _cellIndex.cellStart;
+    size_t                nBlocks = _cellIndex.blockMin.size();
+
+    // Blocks are split into contiguous chunks, one per thread, and the
+    // per-chunk output is concatenated in chunk order so the vertex order
+    // does not depend on the number of threads
+    //
+    int nChunks = 1;
+#pragma omp parallel
+    {
+#pragma omp single
+        nChunks = omp_get_num_threads();
+    }
+    vector<vector<float>> chunkVerts(nChunks);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int chunk = 0; chunk < nChunks; chunk++) {
+        vector<float> &out = chunkVerts[chunk];
+        size_t         b0 = nBlocks * chunk / nChunks;
+        size_t         b1 = nBlocks * (chunk + 1) / nChunks;
+        for (size_t b = b0; b < b1; b++) {
+            // A segment is only produced for an edge with one end <= contour
+            // and the other > contour
+            //
+            if (contour < _cellIndex.blockMin[b] || contour >= _cellIndex.blockMax[b]) continue;
+
+            for (size_t c = _cellIndex.blockStart[b]; c < _cellIndex.blockStart[b + 1]; c++) {
+                size_t n = cellStart[c + 1] - cellStart[c];
+                const size_t *cn = &cellNodes[cellStart[c]];
+                for (size_t a = n - 1, bi = 0; bi < n; a = bi++) {
+                    const float *pa = &nodes[cn[a] * 4];
+                    const float *pb = &nodes[cn[bi] * 4];
+
+                    if ((pa[3] <= contour && pb[3] <= contour) || (pa[3] > contour && pb[3] > contour)) continue;
+
+                    float t = (contour - pa[3]) / (pb[3] - pa[3]);
+                    out.push_back(pa[0] + t * (pb[0] - pa[0]));
+                    out.push_back(pa[1] + t * (pb[1] - pa[1]));
+                    out.push_back(pa[2] + t * (pb[2] - pa[2]));
+                    out.push_back(contour);
+                }
+            }
+        }
+    }
+
+    size_t total = 0;
+    for (const auto &v : chunkVerts) total += v.size();
+    vertices.clear();
+    vertices.reserve(total);
+    for (const auto &v : chunkVerts) vertices.insert(vertices.end(), v.begin(), v.end());
+}
+
+void ContourRenderer::_updateLevels(const vector<double> &contours)
+{
+    // Drop levels that are no longer requested. Their buffer slices are
+    // simply abandoned until the next repack
+    //
+    vector<ContourLevel> levels;
+    for (auto &level : _levels) {
+        if (std::find(contours.begin(), contours.end(), level.value) != contours.end()) levels.push_back(std::move(level));
+    }
+    _levels = std::move(levels);
+
+    size_t firstNew = _levels.size();
+    for (double contour : contours) {
+        bool cached = false;
+        for (const auto &level : _levels) cached |= level.value == contour;
+        if (cached) continue;
+
+        _levels.push_back({contour, {}, 0});
+        _marchLevel(contour, _levels.back().vertices);
+    }
+
+    size_t live = 0, added = 0;
+    for (size_t i = 0; i < _levels.size(); i++) {
+        size_t n = _levels[i].vertices.size() / 4;
+        live += n;
+        if (i >= firstNew) added += n;
+    }
+
+    bool repack = _bufferUsed + added > _bufferCapacity || live < _bufferUsed / 2;
+    if (repack) {
+        _bufferCapacity = live + live / 2;
+        _bufferUsed = 0;
+        firstNew = 0;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    if (repack) glBufferData(GL_ARRAY_BUFFER, _bufferCapacity * sizeof(VertexData), NULL, GL_DYNAMIC_DRAW);
+    for (size_t i = firstNew; i < _levels.size(); i++) {
+        ContourLevel &level = _levels[i];
+        size_t        n = level.vertices.size() / 4;
+        level.offset = _bufferUsed;
+        if (n) glBufferSubData(GL_ARRAY_BUFFER, level.offset * sizeof(VertexData), n * sizeof(VertexData), level.vertices.data());
+        _bufferUsed += n;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _nVertices = live;
+    _cacheParams.contourValues = contours;
+}
+
 int ContourRenderer::_buildCache(bool fast)
 {
     ContourParams *cParams = (ContourParams *)GetActiveParams();
     _saveCacheParams();
 
-    vector<VertexData> vertices;
+    // Geometry changed, every level has to be marched again
+    //
+    _levels.clear();
+    _bufferUsed = 0;
+    _cacheParams.contourValues.clear();
+    _cellIndex.nodes.clear();
+    _cellIndex.cellNodes.clear();
+    _cellIndex.cellStart.clear();
+    _cellIndex.blockStart.clear();
+    _cellIndex.blockMin.clear();
+    _cellIndex.blockMax.clear();
 
     if (cParams->GetVariableName().empty()) {
         MyBase::SetErrMsg("Missing Variable");
         return 1;
     }
-    vector<double> contours = cParams->GetContourValues(_cacheParams.varName);
 
     CoordType boxMin = {0.0, 0.0, 0.0};
     CoordType boxMax = {0.0, 0.0, 0.0};
@@ -207,62 +449,22 @@ int ContourRenderer::_buildCache(bool fast)
         }
     }
 
-    double mv = grid->GetMissingValue();
-    float  Z0 = GetDefaultZ(_dataMgr, _cacheParams.ts);
-
-    Grid::ConstCellIterator it = grid->ConstCellBegin(boxMin, boxMax);
-
-    size_t           maxNodes = grid->GetMaxVertexPerCell();
-    vector<DimsType> nodes(maxNodes);
-
-    vector<float>     values(maxNodes);
-    vector<CoordType> coords(maxNodes);
-
-    Grid::ConstCellIterator end = grid->ConstCellEnd();
-    for (; it != end; ++it) {
-        const DimsType &cell = *it;
-        grid->GetCellNodes(cell, nodes);
-
-        bool hasMissing = false;
-        for (int i = 0; i < nodes.size(); i++) {
-            grid->GetUserCoordinates(nodes[i], coords[i]);
-            values[i] = grid->GetValueAtIndex(nodes[i]);
-            if (values[i] == mv) { hasMissing = true; }
-        }
-        if (hasMissing) continue;
-
-        for (int ci = 0; ci != contours.size(); ci++) {
-            for (int a = nodes.size() - 1, b = 0; b < nodes.size(); a++, b++) {
-                if (a == nodes.size()) a = 0;
-                float contour = contours[ci];
-
-                if ((values[a] <= contour && values[b] <= contour) || (values[a] > contour && values[b] > contour)) continue;
-
-                float t = (contour - values[a]) / (values[b] - values[a]);
-                float v[3];
-                v[0] = coords[a][0] + t * (coords[b][0] - coords[a][0]);
-                v[1] = coords[a][1] + t * (coords[b][1] - coords[a][1]);
-                v[2] = coords[a][2] + t * (coords[b][2] - coords[a][2]);
-
-                if (dims == 2) v[2] = Z0;
-
-                if (heightGrid) {
-                    float aHeight = heightGrid->GetValueAtIndex(nodes[a]);
-                    float bHeight = heightGrid->GetValueAtIndex(nodes[b]);
-                    v[2] = aHeight + t * (bHeight - aHeight);
-                }
-
-                vertices.push_back({v[0], v[1], v[2], contour});
-            }
-        }
+    // Value ranges of the grid's data blocks. They are cached by the
+    // DataMgr with the region for grids that come straight from it. A grid
+    // with a single block, such as the 3D slice, is never culled by block,
+    // so its range is not needed
+    //
+    vector<float>         blockMins, blockMaxs;
+    const vector<size_t> &bdims = grid->GetDimensionInBlks();
+    size_t                nGridBlocks = bdims.size() ? Wasp::VProduct(bdims.data(), bdims.size()) : 0;
+    if (nGridBlocks > 1) {
+        if (grid2)
+            grid->GetBlockCellRanges(blockMins, blockMaxs);
+        else
+            _dataMgr->GetBlockDataRanges(_cacheParams.ts, _cacheParams.varName, _cacheParams.level, _cacheParams.lod, boxMin, boxMax, blockMins, blockMaxs);
     }
 
-    _nVertices = vertices.size();
-    glBindVertexArray(_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VertexData), vertices.data(), GL_DYNAMIC_DRAW);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _buildCellIndex(grid, heightGrid, blockMins, blockMaxs, boxMin, boxMax, dims == 2, GetDefaultZ(_dataMgr, _cacheParams.ts));
 
     if (grid) delete grid;
     if (grid2) delete grid2;
@@ -280,6 +482,11 @@ int ContourRenderer::_paintGL(bool fast)
     }
     if (rc != 0) return rc;
 
+    // Only isovalues that are not cached yet are marched
+    //
+    vector<double> contours = ((ContourParams *)GetActiveParams())->GetContourValues(_cacheParams.varName);
+    if (contours != _cacheParams.contourValues) _updateLevels(contours);
+
     RenderParams *  rp = GetActiveParams();
     MapperFunction *tf = rp->GetMapperFunc(rp->GetVariableName());
     float           lut[4 * 256];
@@ -307,7 +514,10 @@ int ContourRenderer::_paintGL(bool fast)
     glDepthMask(true);
     glEnable(GL_DEPTH_TEST);
     glBindVertexArray(_VAO);
-    glDrawArrays(GL_LINES, 0, _nVertices);
+    for (const auto &level : _levels) {
+        if (level.vertices.empty()) continue;
+        glDrawArrays(GL_LINES, level.offset, level.vertices.size() / 4);
+    }
 
     glBindVertexArray(0);
     shader->UnBind();
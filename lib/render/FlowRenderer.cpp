@@ -7,6 +7,8 @@
 #include <cstring>
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <cfloat>
 #include <vapor/Progress.h>
 
 #define GL_ERROR -20
@@ -17,6 +19,75 @@ using glm::vec4;
 
 static RendererRegistrar<FlowRenderer> registrar(FlowRenderer::GetClassType(), FlowParams::GetClassType());
 
+namespace {
+// Counter-based random numbers: the n-th number only depends on the key and n,
+// so any range of them can be generated by any thread, in any order.
+// This is the SplitMix64 finalizer applied to the key and the counter.
+uint64_t RandomBits(uint64_t key, uint64_t counter)
+{
+    uint64_t z = key + (counter + 1) * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// A uniformly distributed float in [lo, hi), from the n-th random number
+float RandomUniform(uint64_t key, uint64_t counter, float lo, float hi)
+{
+    const float u = float(RandomBits(key, counter) >> 40) * (1.0f / 16777216.0f);    // 24 random bits in [0, 1)
+    return std::min(lo + u * (hi - lo), std::nextafter(hi, lo));
+}
+
+// Douglas-Peucker simplification of a polyline whose vertices have a position "p"
+// and a value "v". A vertex is only dropped if it lies within "tolerance" of the
+// segment that replaces it, and its value within "valueTolerance" of the value
+// interpolated along that segment. The end points are always kept.
+template<typename Vertex> void SimplifyPolyline(const std::vector<Vertex> &in, float tolerance, float valueTolerance, std::vector<Vertex> &out)
+{
+    out.clear();
+    const size_t n = in.size();
+    if (n < 3) {
+        out = in;
+        return;
+    }
+
+    std::vector<char> keep(n, 0);
+    keep[0] = keep[n - 1] = 1;
+    std::vector<std::pair<size_t, size_t>> ranges(1, {0, n - 1});
+    while (!ranges.empty()) {
+        const size_t a = ranges.back().first, b = ranges.back().second;
+        ranges.pop_back();
+        if (b - a < 2) continue;
+
+        // Find the vertex with the largest error relative to the tolerances
+        const vec3  ab = in[b].p - in[a].p;
+        const float len2 = glm::dot(ab, ab);
+        float       worst = 1.f;
+        size_t      split = a;
+        for (size_t i = a + 1; i < b; i++) {
+            const float t = len2 > 0.f ? glm::clamp(glm::dot(in[i].p - in[a].p, ab) / len2, 0.f, 1.f) : 0.f;
+            const float dist = glm::distance(in[i].p, in[a].p + t * ab);
+            const float dv = std::abs(in[i].v - (in[a].v + t * (in[b].v - in[a].v)));
+            float       err = std::max(dist / tolerance, dv / valueTolerance);
+            if (std::isnan(err)) err = FLT_MAX;    // keep missing values where they are
+            if (err > worst) {
+                worst = err;
+                split = i;
+            }
+        }
+        if (split == a) continue;
+
+        keep[split] = 1;
+        ranges.push_back({a, split});
+        ranges.push_back({split, b});
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (keep[i]) out.push_back(in[i]);
+    }
+}
+}    // namespace
+
 // Constructor
 FlowRenderer::FlowRenderer(const ParamsMgr *pm, std::string &winName, std::string &dataSetName, std::string &instName, DataMgr *dataMgr)
 : Renderer(pm, winName, dataSetName, FlowParams::GetClassType(), FlowRenderer::GetClassType(), instName, dataMgr),
@@ -283,28 +354,26 @@ int FlowRenderer::_paintGL(bool fast)
 
             Progress::StartIndefinite("Performing flowline calculations");
             Progress::Update(0);
-            rv = _advection.AdvectSteps(&_velocityField, deltaT, numOfSteps, fixedSteps);
-            _printNonZero(rv, __FILE__, __func__, __LINE__);
-
-            // If the advection is bi-directional
+            // If the advection is bi-directional, both directions are advected as one job
             if (_2ndAdvection) {
-                Progress::Update(5);
                 assert(deltaT > 0.0);
                 auto deltaT2 = deltaT * -1.0;
 
-                rv = _2ndAdvection->AdvectSteps(&_velocityField, deltaT2, numOfSteps, fixedSteps);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
-            }
+                rv = _advection.AdvectSteps(&_velocityField, deltaT, numOfSteps, fixedSteps, *_2ndAdvection, deltaT2);
+            } else
+                rv = _advection.AdvectSteps(&_velocityField, deltaT, numOfSteps, fixedSteps);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
             Progress::Finish();
         }
 
         // Advection scheme 2: advect to a certain timestamp.
-        // This scheme is used for unsteady flow
-        else {
-            for (int i = 1; i <= _cache_currentTS; i++) {
-                rv = _advection.AdvectTillTime(&_velocityField, _timestamps.at(i - 1), deltaT, _timestamps.at(i), fixedSteps);
-                _printNonZero(rv, __FILE__, __func__, __LINE__);
-            }
+        // This scheme is used for unsteady flow.
+        // One call covers all time steps, so that the velocity field loads the
+        // grids of each time step while the particles advect through the
+        // previous one. Intervals the particles already passed are skipped.
+        else if (_cache_currentTS > 0) {
+            rv = _advection.AdvectTillTime(&_velocityField, _timestamps.at(0), deltaT, _timestamps.at(_cache_currentTS), fixedSteps);
+            _printNonZero(rv, __FILE__, __func__, __LINE__);
         }
 
         _advectionComplete = true;
@@ -318,10 +387,10 @@ int FlowRenderer::_paintGL(bool fast)
             vector<double> integrationVolumeMin, integrationVolumeMax;
             params->GetIntegrationBox()->GetExtents(integrationVolumeMin, integrationVolumeMax);
             float distScale = params->GetValueDouble(params->_integrationScalarTag, 1.f);
-            rv = _advection.CalculateParticleIntegratedValues(&_colorField, true, distScale, integrationVolumeMin, integrationVolumeMax);
+            rv = _advection.CalculateParticleIntegratedValues(&_colorField, true, distScale, integrationVolumeMin, integrationVolumeMax, _cache_colorSampleStride);
             _printNonZero(rv, __FILE__, __func__, __LINE__);
             if (_2ndAdvection)    // bi-directional advection
-                rv = _2ndAdvection->CalculateParticleIntegratedValues(&_colorField, true, distScale, integrationVolumeMin, integrationVolumeMax);
+                rv = _2ndAdvection->CalculateParticleIntegratedValues(&_colorField, true, distScale, integrationVolumeMin, integrationVolumeMax, _cache_colorSampleStride);
 
             if (setAllToFinalValue) {
                 int numSamplesPerStream;
@@ -340,10 +409,10 @@ int FlowRenderer::_paintGL(bool fast)
             params->SetValueLongVec(RenderParams::CustomHistogramDataTag, "", histo);
             params->SetValueDoubleVec(RenderParams::CustomHistogramRangeTag, "", histoRange);
         } else {
-            rv = _advection.CalculateParticleValues(&_colorField, true);
+            rv = _advection.CalculateParticleValues(&_colorField, true, _cache_colorSampleStride);
             _printNonZero(rv, __FILE__, __func__, __LINE__);
             if (_2ndAdvection)    // bi-directional advection
-                rv = _2ndAdvection->CalculateParticleValues(&_colorField, true);
+                rv = _2ndAdvection->CalculateParticleValues(&_colorField, true, _cache_colorSampleStride);
 
             if (params->GetValueDoubleVec(RenderParams::CustomHistogramRangeTag).size()) {
                 params->SetValueLongVec(RenderParams::CustomHistogramDataTag, "", {});
@@ -361,6 +430,11 @@ int FlowRenderer::_paintGL(bool fast)
 
     rv = 0;
 
+    // The streams, or how they are drawn, changed since the flow lines were built
+    if (_renderStatus != FlowStatus::UPTODATE) {
+        for (auto &cache : _flowlineCaches) cache.valid = false;
+    }
+
     if (params->GetValueLong("old_render", 0)) {
         _renderFromAnAdvectionLegacy(&_advection, params, fast);
         if (_2ndAdvection) {    // If the advection is bi-directional
@@ -387,7 +461,8 @@ int FlowRenderer::_paintGL(bool fast)
     _restoreGLState();
 
     // Release grids that are acquired during this paint event
-    // before their DataMgr is destroyed by others.
+    // before their DataMgr is destroyed by others. Grids loaded ahead
+    // of time are all used by the advection above, which is complete.
     _velocityField.ReleaseLockedGrids();
     _colorField.ReleaseLockedGrids();
 
@@ -398,88 +473,166 @@ int FlowRenderer::_renderAdvection(const flow::Advection *adv)
 {
     FlowParams *rp = dynamic_cast<FlowParams *>(GetActiveParams());
 
+    // Simplification keeps the flow lines within the screen space tolerance, and
+    // within one color map entry of the color mapped values.
+    const float    pixels = float(rp->GetValueDouble(FlowParams::RenderSimplifyToleranceTag, 0.0));
+    const float    tolerance = _getSimplifyTolerance(rp);
+    const float    valueTolerance = (tolerance > 0.f && !rp->UseSingleColor()) ? _colorMapRange[2] / std::max<size_t>(1, _colorMap.size() / 4) : FLT_MAX;
+    FlowlineCache &cache = _flowlineCaches[adv == &_advection ? 0 : 1];
+
+    // Simplify again whenever the tolerance setting changes. With the same setting,
+    // only once the view (e.g., zooming) shrinks the tolerance enough for the error
+    // to show, or grows it enough that many more vertices could go.
+    const bool settingChanged = pixels != cache.pixels || valueTolerance != cache.valueTolerance;
+    const bool viewChanged = tolerance < 0.8f * cache.tolerance || tolerance > 2.f * cache.tolerance;
+    if (cache.valid && (settingChanged || viewChanged)) {
+        cache.valid = false;
+        _renderStatus = FlowStatus::SIMPLE_OUTOFDATE;
+    }
+
     if (_renderStatus != FlowStatus::UPTODATE) {
-        int nStreams = adv->GetNumberOfStreams();
+        if (!cache.valid) {
+            _buildFlowlines(adv, tolerance, valueTolerance, cache);
+            cache.pixels = pixels;
+        }
+
+        assert(glIsVertexArray(_VAO) == GL_TRUE);
+        assert(glIsBuffer(_VBO) == GL_TRUE);
 
-        typedef struct {
-            vec3  p;
-            float v;
-        } Vertex;
-        vector<Vertex> vertices;
-        vector<int>    sizes;
-        vector<Vertex> sv;
+        glBindVertexArray(_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(FlowlineVertex) * cache.vertices.size(), cache.vertices.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-        // If streams are larger than this then need to skip remaining
-        size_t maxSamples = rp->GetSteadyNumOfSteps() + 1;
+        _streamSizes = cache.sizes;
+        _renderStatus = FlowStatus::UPTODATE;
+    }
 
-        // First calculate the starting time stamp. Copied from legacy.
-        double startingTime = _timestamps[0];
-        if (!_cache_isSteady) {
-            startingTime = _timestamps[0];
-            // note that _cache_currentTS is cast to a signed integer.
-            if (int(_cache_currentTS) - _cache_pastNumOfTimeSteps > 0) startingTime = _timestamps[_cache_currentTS - _cache_pastNumOfTimeSteps];
-        }
+    bool show_dir = rp->GetValueLong(FlowParams::RenderShowStreamDirTag, false);
 
-        for (int s = 0; s < nStreams; s++) {
-            const vector<flow::Particle> &stream = adv->GetStreamAt(s);
-            sv.clear();
-            int sn = stream.size();
-            if (_cache_isSteady) sn = std::min(sn, (int)maxSamples);
+    _renderAdvectionHelper(show_dir);
+    if (show_dir) _renderAdvectionHelper(false);
 
-            for (int i = 0; i < sn + 1; i++) {
-                // "IsSpecial" means don't render this sample.
-                if (i == sn || stream[i].IsSpecial()) {
-                    int svn = sv.size();
+    return 0;
+}
 
-                    if (svn < 2) {
-                        sv.clear();
-                        continue;
-                    }
+void FlowRenderer::_buildFlowlines(const flow::Advection *adv, float tolerance, float valueTolerance, FlowlineCache &cache) const
+{
+    const FlowParams *rp = dynamic_cast<const FlowParams *>(GetActiveParams());
+    const long        nStreams = adv->GetNumberOfStreams();
 
-                    vec3 prep(-normalize(sv[1].p - sv[0].p) + sv[0].p);
-                    vec3 post(normalize(sv[svn - 1].p - sv[svn - 2].p) + sv[svn - 1].p);
+    // If streams are larger than this then need to skip remaining
+    size_t maxSamples = rp->GetSteadyNumOfSteps() + 1;
 
-                    size_t vn = vertices.size();
-                    vertices.resize(vn + svn + 2);
-                    vertices[vn] = {prep, sv[0].v};
-                    vertices[vertices.size() - 1] = {post, sv[svn - 1].v};
+    // First calculate the starting time stamp. Copied from legacy.
+    double startingTime = _timestamps[0];
+    if (!_cache_isSteady) {
+        startingTime = _timestamps[0];
+        // note that _cache_currentTS is cast to a signed integer.
+        if (int(_cache_currentTS) - _cache_pastNumOfTimeSteps > 0) startingTime = _timestamps[_cache_currentTS - _cache_pastNumOfTimeSteps];
+    }
 
-                    memcpy(vertices.data() + vn + 1, sv.data(), sizeof(Vertex) * svn);
+    // Streams are built (and simplified) independently, then concatenated in order.
+    std::vector<std::vector<FlowlineVertex>> streamVertices(nStreams);
+    std::vector<std::vector<int>>            streamSizes(nStreams);
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (long s = 0; s < nStreams; s++) {
+        const vector<flow::Particle> &stream = adv->GetStreamAt(s);
+        vector<FlowlineVertex> &      vertices = streamVertices[s];
+        vector<FlowlineVertex>        sv, simplified;
+        int                           sn = stream.size();
+        if (_cache_isSteady) sn = std::min(sn, (int)maxSamples);
+
+        for (int i = 0; i < sn + 1; i++) {
+            // "IsSpecial" means don't render this sample.
+            if (i == sn || stream[i].IsSpecial()) {
+                if (tolerance > 0.f) {
+                    SimplifyPolyline(sv, tolerance, valueTolerance, simplified);
+                    sv.swap(simplified);
+                }
+                int svn = sv.size();
 
-                    sizes.push_back(svn + 2);
+                if (svn < 2) {
                     sv.clear();
-                } else {
-                    const flow::Particle &p = stream[i];
-
-                    if (_cache_isSteady) {
-                        sv.push_back({p.location, p.value});
-                    } else {
-                        if (p.time > _timestamps.at(_cache_currentTS)) continue;
-                        if (p.time >= startingTime) sv.push_back({p.location, p.value});
-                    }
+                    continue;
                 }
-            }
 
-            _renderStatus = FlowStatus::UPTODATE;
-        }
+                vec3 prep(-normalize(sv[1].p - sv[0].p) + sv[0].p);
+                vec3 post(normalize(sv[svn - 1].p - sv[svn - 2].p) + sv[svn - 1].p);
 
-        assert(glIsVertexArray(_VAO) == GL_TRUE);
-        assert(glIsBuffer(_VBO) == GL_TRUE);
+                size_t vn = vertices.size();
+                vertices.resize(vn + svn + 2);
+                vertices[vn] = {prep, sv[0].v};
+                vertices[vertices.size() - 1] = {post, sv[svn - 1].v};
 
-        glBindVertexArray(_VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STREAM_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+                memcpy(vertices.data() + vn + 1, sv.data(), sizeof(FlowlineVertex) * svn);
+
+                streamSizes[s].push_back(svn + 2);
+                sv.clear();
+            } else {
+                const flow::Particle &p = stream[i];
 
-        _streamSizes = sizes;
+                if (_cache_isSteady) {
+                    sv.push_back({p.location, p.value});
+                } else {
+                    if (p.time > _timestamps.at(_cache_currentTS)) continue;
+                    if (p.time >= startingTime) sv.push_back({p.location, p.value});
+                }
+            }
+        }
     }
 
-    bool show_dir = rp->GetValueLong(FlowParams::RenderShowStreamDirTag, false);
+    size_t nVertices = 0, nSizes = 0;
+    for (long s = 0; s < nStreams; s++) {
+        nVertices += streamVertices[s].size();
+        nSizes += streamSizes[s].size();
+    }
+    cache.vertices.clear();
+    cache.sizes.clear();
+    cache.vertices.reserve(nVertices);
+    cache.sizes.reserve(nSizes);
+    for (long s = 0; s < nStreams; s++) {
+        cache.vertices.insert(cache.vertices.end(), streamVertices[s].begin(), streamVertices[s].end());
+        cache.sizes.insert(cache.sizes.end(), streamSizes[s].begin(), streamSizes[s].end());
+    }
+    cache.tolerance = tolerance;
+    cache.valueTolerance = valueTolerance;
+    cache.valid = true;
+}
 
-    _renderAdvectionHelper(show_dir);
-    if (show_dir) _renderAdvectionHelper(false);
+float FlowRenderer::_getSimplifyTolerance(FlowParams *rp)
+{
+    const double pixels = rp->GetValueDouble(FlowParams::RenderSimplifyToleranceTag, 0.0);
+    if (!(pixels > 0.0)) return 0.f;
+
+    // Samples, direction glyphs, and faded tails are placed by counting vertices,
+    // which simplification would change.
+    if (rp->GetValueLong(FlowParams::RenderTypeTag, FlowParams::RenderTypeStream) == FlowParams::RenderTypeSamples) return 0.f;
+    if (rp->GetValueLong(FlowParams::RenderShowStreamDirTag, false) || rp->GetValueLong(FlowParams::RenderFadeTailTag, false)) return 0.f;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[3] <= 0) return 0.f;
+
+    // A pixel covers the least distance where the flow lines are closest to the camera.
+    // Use the corner of the region closest to it, but not closer than the near plane.
+    const glm::mat4 MVP = _glManager->matrixManager->GetModelViewProjectionMatrix();
+    const glm::mat4 P = _glManager->matrixManager->GetProjectionMatrix();
+    CoordType       minExt, maxExt;
+    rp->GetBox()->GetExtents(minExt, maxExt);
+    float w = FLT_MAX;
+    for (int c = 0; c < 8; c++) {
+        vec4 corner(float((c & 1) ? maxExt[0] : minExt[0]), float((c & 2) ? maxExt[1] : minExt[1]), float((c & 4) ? maxExt[2] : minExt[2]), 1.f);
+        w = std::min(w, (MVP * corner).w);
+    }
+    if (P[2][3] != 0.f) w = std::max(w, P[3][2] / (P[2][2] - 1.f));    // perspective
+    if (!(w > 0.f) || P[1][1] == 0.f) return 0.f;
 
-    return 0;
+    // The size of a pixel in eye space, then in data space, which the scales stretch
+    const float pixelSize = 2.f * w / (std::abs(P[1][1]) * viewport[3]);
+    const vec3  scales = _getScales();
+    return float(pixels) * pixelSize / std::max(scales.x, std::max(scales.y, scales.z));
 }
 
 int FlowRenderer::_renderAdvectionHelper(bool renderDirection)
@@ -935,6 +1088,12 @@ int FlowRenderer::_updateFlowCacheAndStates(const FlowParams *params)
     _cache_integrationDistScalar = integrationDistScalar;
     _cache_integrationVolume = integrationVolume;
 
+    const auto colorSampleStride = size_t(std::max(1L, params->GetValueLong(FlowParams::ColorSampleStrideTag, 1)));
+    if (colorSampleStride != _cache_colorSampleStride) {
+        _colorStatus = FlowStatus::SIMPLE_OUTOFDATE;
+        _cache_colorSampleStride = colorSampleStride;
+    }
+
     //
     // Now we branch into steady and unsteady cases, and treat them separately
     //
@@ -1165,19 +1324,16 @@ int FlowRenderer::_genSeedsRakeRandomBiased(std::vector<flow::Particle> &seeds)
      * The first batch of these seeds are used as the final seeds.
      */
 
-    /* Create three uniform distributions in 3 dimensions */
-    unsigned int                          procID = 32;
-    std::mt19937                          gen(procID);    // Standard mersenne_twister engine
-    std::uniform_real_distribution<float> distX(_cache_rake[0], _cache_rake[1]);
-    std::uniform_real_distribution<float> distY(_cache_rake[2], _cache_rake[3]);
-
     // Now we generate many seeds.
     // We test missing values in case 1) the bias variable does have missing values, and 2)
     // the rake extents are outside of the bias variable.
     // Thus, we only keep random seeds that are falling on non-missing-value locations.
-    glm::vec3           loc;
-    std::vector<double> locD(3);
-    auto                timeVal = _timestamps.at(0);
+    //
+    // Candidates are drawn in parallel batches. Candidate i takes its coordinates from
+    // the random numbers 3i to 3i+2 of a counter-based generator, and candidates are
+    // kept in the order of i, so the seeds don't depend on the number of threads.
+    const uint64_t randKey = 32;    // Use a fixed value for the generator seed.
+    auto           timeVal = _timestamps.at(0);
     // This is the total number of seeds to generate, based on the bias strength.
     auto numOfSeedsToGen = numOfSeedsNeeded * (std::abs(_cache_rakeBiasStrength) + 1);
     long numOfTrials = 0;
@@ -1186,32 +1342,35 @@ int FlowRenderer::_genSeedsRakeRandomBiased(std::vector<flow::Particle> &seeds)
     // Note: in the case that too many random seeds fall on missing values,
     // we set a limit of 10 times numOfSeedsToGen.
     long  numOfTrialLimit = 10 * numOfSeedsToGen;
-    float val, mv = grid->GetMissingValue();
-    if (dim == 3) {
-        std::uniform_real_distribution<float> distZ(_cache_rake[4], _cache_rake[5]);
-        while (numOfTrials < numOfTrialLimit && seeds.size() < numOfSeedsToGen) {
-            loc.x = distX(gen);
-            locD[0] = loc.x;
-            loc.y = distY(gen);
-            locD[1] = loc.y;
-            loc.z = distZ(gen);
-            locD[2] = loc.z;
-            val = grid->GetValue(locD);
-            if (val != mv) seeds.emplace_back(loc, timeVal, val);
-            numOfTrials++;
+    float mv = grid->GetMissingValue();
+    float defaultZ = (dim == 3) ? 0.0f : Renderer::GetDefaultZ(_dataMgr, params->GetCurrentTimestep());
+
+    // Grid caches its user extents lazily; fill the cache here so the
+    // parallel lookups below only ever read it.
+    CoordType minu, maxu;
+    grid->GetUserExtents(minu, maxu);
+
+    std::vector<glm::vec3> batchLocs;
+    std::vector<float>     batchVals;
+    while (numOfTrials < numOfTrialLimit && seeds.size() < numOfSeedsToGen) {
+        // Draw about as many candidates as seeds are still missing, and at least a few thousand.
+        const long batchSize = std::min(numOfTrialLimit - numOfTrials, std::max<long>(numOfSeedsToGen - (long)seeds.size(), 4096));
+        batchLocs.resize(batchSize);
+        batchVals.resize(batchSize);
+
+#pragma omp parallel for
+        for (long i = 0; i < batchSize; i++) {
+            const uint64_t n = 3 * uint64_t(numOfTrials + i);
+            glm::vec3      loc;
+            loc.x = RandomUniform(randKey, n, _cache_rake[0], _cache_rake[1]);
+            loc.y = RandomUniform(randKey, n + 1, _cache_rake[2], _cache_rake[3]);
+            loc.z = (dim == 3) ? RandomUniform(randKey, n + 2, _cache_rake[4], _cache_rake[5]) : defaultZ;
+            batchLocs[i] = loc;
+            batchVals[i] = grid->GetValue(CoordType{loc.x, loc.y, loc.z});
         }
-    } else    // dim == 2
-    {
-        const auto dfz = Renderer::GetDefaultZ(_dataMgr, params->GetCurrentTimestep());
-        loc.z = dfz;
-        locD[2] = dfz;
-        while (numOfTrials < numOfTrialLimit && seeds.size() < numOfSeedsToGen) {
-            loc.x = distX(gen);
-            locD[0] = loc.x;
-            loc.y = distY(gen);
-            locD[1] = loc.y;
-            val = grid->GetValue(locD);
-            if (val != mv) seeds.emplace_back(loc, timeVal, val);
+
+        for (long i = 0; i < batchSize && seeds.size() < numOfSeedsToGen; i++) {
+            if (batchVals[i] != mv) seeds.emplace_back(batchLocs[i], timeVal, batchVals[i]);
             numOfTrials++;
         }
     }
@@ -3,6 +3,7 @@
 #include "vapor/VAssert.h"
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
 #ifdef WIN32
     #include <geotiff/geotiff.h>
     #include <geotiff/geo_normalize.h>
@@ -16,10 +17,41 @@
 #include <vapor/GeoTileMercator.h>
 #include <vapor/TMSUtils.h>
 #include <vapor/GeoImageTMS.h>
+#include <vapor/OpenMPSupport.h>
 
 using namespace VAPoR;
 using namespace Wasp;
 
+namespace {
+
+// Reads single TMS tiles. The GeoImage TIFF routines keep the open file in
+// the object, so each decoding thread needs its own reader.
+//
+class TileReader : public GeoImage {
+public:
+    TileReader() : GeoImage(8, 4) {}
+
+    int            Initialize(string path, vector<double> times) override { return (0); }
+    unsigned char *GetImage(size_t ts, size_t &width, size_t &height) override { return (NULL); }
+    unsigned char *GetImage(size_t ts, const double pcsExtentsReq[4], string proj4StringReq, size_t maxWidthReq, size_t maxHeightReq, double pcsExtentsImg[4], double geoCornersImg[8],
+                            string &proj4StringImg, size_t &width, size_t &height) override
+    {
+        return (NULL);
+    }
+
+    int Read(string path, unsigned char *tile)
+    {
+        int rc = GeoImage::TiffOpen(path);
+        if (rc < 0) return (-1);
+
+        rc = GeoImage::TiffReadImage(0, tile);
+        GeoImage::TiffClose();
+        return (rc);
+    }
+};
+
+};    // namespace
+
 GeoImageTMS::GeoImageTMS() : GeoImage(8, 4)
 {
     _dir.clear();
@@ -27,9 +59,8 @@ GeoImageTMS::GeoImageTMS() : GeoImage(8, 4)
     _maxLOD = 0;
     _texture = NULL;
     _textureSize = 0;
-    _tileBuf = NULL;
-    _tileBufSize = 0;
     _geotile = NULL;
+    _maxCachedTiles = 256;
 
     // The default projection string for imagery centered at 0 degrees
     // longitude. This string is modified (+lon_0 is edited) if a
@@ -45,9 +76,6 @@ GeoImageTMS::~GeoImageTMS()
     if (_texture) delete[] _texture;
     _textureSize = 0;
 
-    if (_tileBuf) delete[] _tileBuf;
-    _tileBufSize = 0;
-
     if (_geotile) delete _geotile;
 }
 
@@ -57,6 +85,7 @@ int GeoImageTMS::Initialize(string dir, vector<double> times)
 
     if (_geotile) delete _geotile;
     _geotile = NULL;
+    _clearTiles();
     _dir = dir;
     _maxLOD = 0;
 
@@ -80,21 +109,17 @@ int GeoImageTMS::Initialize(string dir, vector<double> times)
     //
     _geotile = new GeoTileMercator(w, h, 4);
 
-    //
-    // Allocate space to buffer a tile
-    //
-    size_t size = w * h * 4;
-    if (_tileBufSize < size) {
-        delete[] _tileBuf;
-        _tileBuf = new unsigned char[size];
-        _tileBufSize = size;
-    }
-
     return (0);
 }
 
 void GeoImageTMS::SetLOD(int lod) { _currentLOD = lod; }
 
+void GeoImageTMS::SetTileCacheSize(size_t n)
+{
+    _maxCachedTiles = n;
+    _evictTiles(0);
+}
+
 unsigned char *GeoImageTMS::GetImage(size_t ts, size_t &width, size_t &height)
 {
     _geotile->GetTileSize(width, height);
@@ -323,6 +348,29 @@ int GeoImageTMS::_getBestLOD(const double myGeoExtentsData[4], int maxWidthReq,
 
 int GeoImageTMS::_getMap(const size_t pixelSW[2], const size_t pixelNE[2], int lod, unsigned char *texture)
 {
+    // Make sure tiles need for this map are loaded. If not, read
+    // and load them
+    //
+    vector<string> quadkeys;
+    _mapTiles(pixelSW, pixelNE, lod, quadkeys);
+
+    int rc = _loadTiles(quadkeys);
+    if (rc < 0) return (-1);
+
+    _touchTiles(quadkeys);
+
+    rc = _geotile->GetMap(pixelSW[0], pixelSW[1], pixelNE[0], pixelNE[1], lod, texture);
+
+    _evictTiles(quadkeys.size());
+    return (rc);
+}
+
+// Quadkeys of the tiles covering the specified ROI
+//
+void GeoImageTMS::_mapTiles(const size_t pixelSW[2], const size_t pixelNE[2], int lod, vector<string> &quadkeys) const
+{
+    quadkeys.clear();
+
     size_t tileX0, tileX1;
     size_t tileY0, tileY1;
     size_t dummy;
@@ -347,27 +395,103 @@ int GeoImageTMS::_getMap(const size_t pixelSW[2], const size_t pixelNE[2], int l
         nytiles = ntiles - ((tileY1 == tileY0) ? 0 : (tileY0 - tileY1 - 1));
     }
 
-    // Make sure tiles need for this map are loaded. If not, read
-    // and load them
-    //
     size_t tileY = tileY0;
     for (size_t y = 0; y < nytiles; y++) {
         size_t tileX = tileX0;
         for (size_t x = 0; x < nxtiles; x++) {
-            string quadkey = _geotile->TileXYToQuadKey(tileX, tileY, lod);
-            if (!_geotile->GetTile(quadkey)) {
-                int rc = _tileRead(_dir, tileX, tileY, lod, _tileBuf);
-                if (rc < 0) return (-1);
-
-                rc = _geotile->Insert(quadkey, _tileBuf);
-                VAssert(!(rc < 0));
-            }
+            quadkeys.push_back(_geotile->TileXYToQuadKey(tileX, tileY, lod));
             tileX = (tileX + 1) % ntiles;
         }
 
         tileY = (tileY + 1) % ntiles;
     }
+}
 
-    int rc = _geotile->GetMap(pixelSW[0], pixelSW[1], pixelNE[0], pixelNE[1], lod, texture);
-    return (rc);
+// Decode the tiles in quadkeys that are not already cached, in parallel,
+// and insert them into _geotile. Returns once all of them are decoded.
+//
+int GeoImageTMS::_loadTiles(const vector<string> &quadkeys)
+{
+    vector<string> missing;
+    vector<string> paths;
+    for (const auto &quadkey : quadkeys) {
+        if (_geotile->GetTile(quadkey)) continue;
+
+        size_t tileX, tileY;
+        int    lod;
+        int    rc = GeoTile::QuadKeyToTileXY(quadkey, tileX, tileY, lod);
+        VAssert(!(rc < 0));
+
+        string path = TMSUtils::TilePath(_dir, tileX, tileY, lod);
+        if (path.empty()) {
+            SetErrMsg("Tile %d %d %d does not exist", tileX, tileY, lod);
+            return (-1);
+        }
+        missing.push_back(quadkey);
+        paths.push_back(path);
+    }
+    if (missing.empty()) return (0);
+
+    size_t w, h;
+    _geotile->GetTileSize(w, h);
+    const size_t tileSize = w * h * 4;
+
+    vector<unsigned char> tiles(missing.size() * tileSize);
+    vector<int>           status(missing.size(), 0);
+
+    // Error reporting through MyBase is not thread safe. Silence it while
+    // decoding and report failures afterwards
+    //
+    bool errMsgEnabled = EnableErrMsg(false);
+#pragma omp parallel
+    {
+        TileReader reader;
+#pragma omp for schedule(dynamic)
+        for (long i = 0; i < (long)missing.size(); i++) { status[i] = reader.Read(paths[i], tiles.data() + i * tileSize); }
+    }
+    EnableErrMsg(errMsgEnabled);
+
+    for (size_t i = 0; i < missing.size(); i++) {
+        if (status[i] < 0) {
+            SetErrMsg("Failed to read tile %s", paths[i].c_str());
+            return (-1);
+        }
+
+        int rc = _geotile->Insert(missing[i], tiles.data() + i * tileSize);
+        VAssert(!(rc < 0));
+    }
+    return (0);
+}
+
+// Mark tiles as most recently used
+//
+void GeoImageTMS::_touchTiles(const vector<string> &quadkeys)
+{
+    for (const auto &quadkey : quadkeys) {
+        auto p = _lruIndex.find(quadkey);
+        if (p != _lruIndex.end()) _lruTiles.erase(p->second);
+
+        _lruTiles.push_front(quadkey);
+        _lruIndex[quadkey] = _lruTiles.begin();
+    }
+}
+
+// Evict least recently used tiles until at most max(_maxCachedTiles,
+// nPinned) remain. The nPinned most recently used tiles are never evicted.
+//
+void GeoImageTMS::_evictTiles(size_t nPinned)
+{
+    size_t limit = std::max(_maxCachedTiles, nPinned);
+    while (_lruTiles.size() > limit) {
+        const string &quadkey = _lruTiles.back();
+        if (_geotile) _geotile->Erase(quadkey);
+        _lruIndex.erase(quadkey);
+        _lruTiles.pop_back();
+    }
+}
+
+void GeoImageTMS::_clearTiles()
+{
+    _lruTiles.clear();
+    _lruIndex.clear();
 }
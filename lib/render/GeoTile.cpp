@@ -62,6 +62,15 @@ int GeoTile::Insert(std::string quadkey, const unsigned char *image)
     return (0);
 }
 
+void GeoTile::Erase(std::string quadkey)
+{
+    std::map<string, unsigned char *>::iterator p = _tiles.find(quadkey);
+    if (p == _tiles.end()) return;
+
+    if (p->second) delete[] p->second;
+    _tiles.erase(p);
+}
+
 const unsigned char *GeoTile::GetTile(string quadkey) const
 {
     map<string, unsigned char *>::const_iterator p = _tiles.find(quadkey);
@@ -16,6 +16,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <algorithm>
 
 #include <vapor/Proj4API.h>
 #include <vapor/CFuncs.h>
@@ -24,6 +26,7 @@
 #include <vapor/ImageRenderer.h>
 #include <vapor/ImageParams.h>
 #include <vapor/FileUtils.h>
+#include <vapor/OpenMPSupport.h>
 
 using namespace VAPoR;
 
@@ -84,6 +87,7 @@ ImageRenderer::ImageRenderer(const ParamsMgr *pm, string winName, string dataSet
     _cacheRefLevel = 0;
     _cacheLod = 0;
     _cacheHgtVar = "";
+    _cacheDefaultZ = 0.0;
     _cacheGeoreferenced = -1;
     _cacheTimestepTex = 0;
     _cacheBoxExtentsTex.clear();
@@ -133,7 +137,7 @@ int ImageRenderer::GetMesh(DataMgr *dataMgr, GLfloat **verts, GLfloat **normals,
 
     // See if already in cache
     //
-    if (!_gridStateDirty() && _sb_verts.GetBuf()) {
+    if (!_gridStateDirty(dataMgr) && _sb_verts.GetBuf()) {
         width = _vertsWidth;
         height = _vertsHeight;
         *verts = (GLfloat *)_sb_verts.GetBuf();
@@ -182,7 +186,7 @@ int ImageRenderer::GetMesh(DataMgr *dataMgr, GLfloat **verts, GLfloat **normals,
 
     //_transformToLocal(_vertsWidth, _vertsHeight, stretchFac);
 
-    _gridStateSet();
+    _gridStateSet(dataMgr, defaultZ);
 
     // Compute vertex normals
     //
@@ -241,22 +245,29 @@ unsigned char *ImageRenderer::_getTexture(DataMgr *dataMgr)
 
         double geoCornersImg[8];    // Coordinates of image corners in geo coords
 
+        vector<double> pcsExtentsImg(_pcsExtentsImg, _pcsExtentsImg + 4);
+        string         proj4StringImg = _proj4StringImg;
+        GLsizei        texWidth = _texWidth;
+        GLsizei        texHeight = _texHeight;
+
         _twoDTex = _getImage(_geoImage, currentTimestep, proj4StringData, _pcsExtentsData, _pcsExtentsImg, geoCornersImg, _proj4StringImg, _texWidth, _texHeight);
 
         if (!_twoDTex) return (NULL);
 
         _texStateSet(dataMgr);
 
-        // Force recompute of mesh
+        // Force recompute of mesh if the new image doesn't cover the same
+        // area at the same resolution as the one the mesh was built for.
+        // A new image for another time step usually does.
         //
-        _gridStateClear();
+        if (pcsExtentsImg != vector<double>(_pcsExtentsImg, _pcsExtentsImg + 4) || proj4StringImg != _proj4StringImg || texWidth != _texWidth || texHeight != _texHeight) _gridStateClear();
     }
     _imageStateSet(times);
 
     return (_twoDTex);
 }
 
-bool ImageRenderer::_gridStateDirty() const
+bool ImageRenderer::_gridStateDirty(DataMgr *dataMgr) const
 {
     ImageParams *myParams = (ImageParams *)GetActiveParams();
 
@@ -269,7 +280,16 @@ bool ImageRenderer::_gridStateDirty() const
     vector<double> boxExtents(minExt);
     boxExtents.insert(boxExtents.end(), maxExt.begin(), maxExt.end());
 
-    return (refLevel != _cacheRefLevel || lod != _cacheLod || hgtVar != _cacheHgtVar || ts != _cacheTimestep || boxExtents != _cacheBoxExtents);
+    if (refLevel != _cacheRefLevel || lod != _cacheLod || hgtVar != _cacheHgtVar || boxExtents != _cacheBoxExtents) return (true);
+
+    // The mesh only depends on the time step through the height
+    // variable and the default Z. Reuse it across time steps when
+    // neither changes.
+    //
+    if (ts == _cacheTimestep) return (false);
+    if (!hgtVar.empty() && dataMgr->IsTimeVarying(hgtVar)) return (true);
+
+    return (GetDefaultZ(dataMgr, ts) != _cacheDefaultZ);
 }
 
 void ImageRenderer::_gridStateClear()
@@ -279,9 +299,10 @@ void ImageRenderer::_gridStateClear()
     _cacheHgtVar.clear();
     _cacheTimestep = -1;
     _cacheBoxExtents.clear();
+    _cacheDefaultZ = 0.0;
 }
 
-void ImageRenderer::_gridStateSet()
+void ImageRenderer::_gridStateSet(DataMgr *dataMgr, double defaultZ)
 {
     ImageParams *myParams = (ImageParams *)GetActiveParams();
     _cacheRefLevel = myParams->GetRefinementLevel();
@@ -292,6 +313,7 @@ void ImageRenderer::_gridStateSet()
     myParams->GetBox()->GetExtents(minExt, maxExt);
     _cacheBoxExtents = minExt;
     _cacheBoxExtents.insert(_cacheBoxExtents.end(), maxExt.begin(), maxExt.end());
+    _cacheDefaultZ = defaultZ;
 }
 
 bool ImageRenderer::_imageStateDirty(const vector<double> &times) const
@@ -519,6 +541,7 @@ int ImageRenderer::_getMeshDisplacedGeo(DataMgr *dataMgr, Grid *hgtGrid, GLsizei
     // vertical coordinate for now.
     //
     GLfloat *verts = (GLfloat *)_sb_verts.GetBuf();
+#pragma omp parallel for
     for (int j = 0; j < height; j++) {
         for (int i = 0; i < width; i++) {
             verts[j * width * 3 + i * 3] = _pcsExtentsImg[0] + (i * deltax);
@@ -528,19 +551,54 @@ int ImageRenderer::_getMeshDisplacedGeo(DataMgr *dataMgr, Grid *hgtGrid, GLsizei
     }
 
     // apply proj4 to transform the points(in place), converting
-    // from Image PCS to Data PCS
+    // from Image PCS to Data PCS. The rows are split into one contiguous
+    // chunk per thread. proj.4 handles can't be shared between threads,
+    // so each chunk gets its own Proj4API, created serially up front. Each
+    // Proj4API has its own proj.4 context, so the chunks don't share
+    // error state either.
     //
-    Proj4API proj4;
+    int nChunks = 1;
+#pragma omp parallel
+    {
+#pragma omp single
+        nChunks = omp_get_num_threads();
+    }
+    nChunks = std::max(1, std::min(nChunks, (int)height));
 
-    int rc = proj4.Transform(_proj4StringImg, proj4String, verts, verts + 1, NULL, width * height, 3);
-    if (rc < 0) {
+    vector<std::unique_ptr<Proj4API>> projs;
+    for (int c = 0; c < nChunks; c++) {
+        projs.emplace_back(new Proj4API());
+        if (projs.back()->Initialize(_proj4StringImg, proj4String) < 0) {
+            MyBase::SetErrMsg("Error in coordinate projection");
+            return (-1);
+        }
+    }
+
+    vector<int> rcs(nChunks, 0);
+    bool        errMsgEnabled = EnableErrMsg(false);
+#pragma omp parallel for schedule(static, 1)
+    for (int c = 0; c < nChunks; c++) {
+        size_t   j0 = (size_t)height * c / nChunks;
+        size_t   j1 = (size_t)height * (c + 1) / nChunks;
+        GLfloat *chunk = verts + j0 * width * 3;
+        rcs[c] = projs[c]->Transform(chunk, chunk + 1, NULL, (j1 - j0) * width, 3);
+    }
+    EnableErrMsg(errMsgEnabled);
+
+    if (std::find_if(rcs.begin(), rcs.end(), [](int rc) { return rc < 0; }) != rcs.end()) {
         MyBase::SetErrMsg("Error in coordinate projection");
         return (-1);
     }
 
-    // Now find vertical coordinate
+    // Now find vertical coordinate. The grid's cached extents are
+    // computed here, before the threads start reading them
     //
     double mv = hgtGrid ? hgtGrid->GetMissingValue() : 0.0;
+    if (hgtGrid) {
+        CoordType minu, maxu;
+        hgtGrid->GetUserExtents(minu, maxu);
+    }
+#pragma omp parallel for
     for (int j = 0; j < height; j++) {
         for (int i = 0; i < width; i++) {
             float x = verts[j * width * 3 + i * 3];
@@ -585,6 +643,11 @@ int ImageRenderer::_getMeshDisplacedNoGeo(DataMgr *dataMgr, Grid *hgtGrid, GLsiz
     //
     GLfloat *verts = (GLfloat *)_sb_verts.GetBuf();
     double   mv = hgtGrid ? hgtGrid->GetMissingValue() : 0.0;
+    if (hgtGrid) {
+        CoordType minu, maxu;
+        hgtGrid->GetUserExtents(minu, maxu);
+    }
+#pragma omp parallel for
     for (int j = 0; j < height; j++) {
         double y = minExt[1] + (j * deltay);
 
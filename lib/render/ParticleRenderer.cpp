@@ -39,6 +39,8 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "vapor/GLManager.h"
 #include <vapor/LegacyGL.h>
+#include <vapor/OpenMPSupport.h>
+#include <vapor/utils.h>
 
 using namespace VAPoR;
 
@@ -62,6 +64,7 @@ ParticleRenderer::ParticleRenderer(const ParamsMgr *pm, string winName, string d
     _cacheParams.rLevel=0;
     _cacheParams.cLevel=0;
     _cacheParams.stride=0;
+    _cacheParams.maxParticles=0;
     _cacheParams.radius=8.0;
     _cacheParams.directionScale=0.;
     _cacheParams.direction=false;
@@ -227,6 +230,7 @@ bool ParticleRenderer::_particleCacheIsDirty() const {
     if (_cacheParams.boxMax != max) return true;
 
     if (_cacheParams.stride    != p->GetValueLong( ParticleParams::StrideTag, 1)) return true;
+    if (_cacheParams.maxParticles != p->GetValueLong( ParticleParams::MaxParticlesTag, 0)) return true;
     if (_cacheParams.varName   != p->GetVariableName()       ) return true;
     if (_cacheParams.fieldVars != p->GetFieldVariableNames() ) return true;
     if (_cacheParams.radiusVarName != p->GetValueString( ParticleParams::RenderRadiusVariableTag, "")) return true;
@@ -250,6 +254,7 @@ void ParticleRenderer::_resetParticleCache() {
     _cacheParams.direction = (bool)p->GetValueLong(ParticleParams::ShowDirectionTag, false); 
     _cacheParams.directionScale = p->GetValueDouble(ParticleParams::DirectionScaleTag, 1.);
     _cacheParams.stride = p->GetValueLong(ParticleParams::StrideTag, 1);
+    _cacheParams.maxParticles = p->GetValueLong(ParticleParams::MaxParticlesTag, 0);
     _cacheParams.varName = p->GetVariableName();
     _cacheParams.fieldVars = p->GetFieldVariableNames();
     _cacheParams.radiusVarName = p->GetValueString( ParticleParams::RenderRadiusVariableTag, "");
@@ -395,73 +400,114 @@ int ParticleRenderer::_getGrids(Grid*& grid, std::vector<Grid*>& vecGrids) const
     return 0;
 }
 
-template<typename T> void ParticleRenderer::UploadDataBuffer(vector<T> buffer) {
-    glBufferData(GL_ARRAY_BUFFER, sizeof(T) * buffer.size(), buffer.data(), GL_STATIC_DRAW);
-    _particlesCount = buffer.size();
-}
-
+// Particles are selected in three steps: nodes inside the box, every
+// stride'th of those, and, if a budget is set, a uniform thinning of the
+// strided set down to exactly maxParticles. Every step depends only on the
+// node order, so the result is identical regardless of the thread count.
+//
+// The node range is split into one contiguous chunk per thread. A first pass
+// flags the nodes inside the box and counts them per chunk; the prefix sum
+// of those counts gives each chunk its first in-box ordinal, from which the
+// output slot of every selected particle follows directly. The second pass
+// then writes into a single preallocated interleaved buffer.
+//
 void ParticleRenderer::_generateTextureData(const Grid* grid, const std::vector<Grid*>& vecGrids) {
-    bool      showDir = _cacheParams.direction;
-    bool      dynamicSize = !_cacheParams.radiusVarName.empty();
-    size_t    stride = max(1L, (long)_cacheParams.stride);
-    auto      node = grid->ConstNodeBegin(_cacheParams.boxMin, _cacheParams.boxMax);
-    auto      nodeEnd = grid->ConstNodeEnd();
-    CoordType coordsBuf;
+    const bool   showDir = _cacheParams.direction;
+    const bool   dynamicSize = !_cacheParams.radiusVarName.empty();
+    const size_t stride = max(1L, (long)_cacheParams.stride);
+    const size_t nFloats = (showDir ? 7 : 4) + (dynamicSize ? 1 : 0);
+    const Grid  *radiusGrid = dynamicSize ? vecGrids[vecGrids.size()-1] : nullptr;
 
-    struct PointDataT {vec3 pos; float val;}; vector<PointDataT> pointData;
-    struct DirectionDataT {vec3 pos; vec3 norm; float val;}; vector<DirectionDataT> directionData;
-    struct PointDynSizeDataT {vec3 pos; float val; float radius;}; vector<PointDynSizeDataT> pointDynSizeData;
-    struct DirectionDynSizeDataT {vec3 pos; vec3 norm; float val; float radius;}; vector<DirectionDynSizeDataT> directionDynSizeData;
-
-    if (showDir) {
+    if (showDir)
         SetupParticleDirectionGL(_VAO, _VBO, dynamicSize);
-        directionData.reserve(_particlesCount);
-    } else {
+    else
         SetupParticlePointGL(_VAO, _VBO, dynamicSize);
-        pointData.reserve(_particlesCount);
-    }
     assert(glIsVertexArray(_VAO) == GL_TRUE);
     assert(glIsBuffer(_VBO) == GL_TRUE);
 
-    for (size_t i = 0; node != nodeEnd;) {
-        if (i % stride) goto step;
-        {
-            const float value = grid->GetValueAtIndex(*node);
-            grid->GetUserCoordinates(*node, coordsBuf);
-            const vec3 p = CoordTypeToVec3(coordsBuf);
-
-            if (showDir){
-                const glm::vec3 norm(
-                    vecGrids[0]->GetValueAtIndex(*node),
-                    vecGrids[1]->GetValueAtIndex(*node),
-                    vecGrids[2]->GetValueAtIndex(*node)
-                );
-                if (dynamicSize)
-                    directionDynSizeData.push_back({p, norm, value, vecGrids[vecGrids.size()-1]->GetValueAtIndex(*node)});
-                else
-                    directionData.push_back({p, norm, value});
-            } else {
-                if (dynamicSize)
-//                    pointDynSizeData.push_back({p, value, *(dirs[dirs.size()-1])});
-                    pointDynSizeData.push_back({p, value, vecGrids[vecGrids.size()-1]->GetValueAtIndex(*node)});
-
-                else
-                    pointData.push_back({p, value});
+    const DimsType       dims = grid->GetNodeDimensions();
+    const size_t         nNodes = Wasp::VProduct(dims.data(), dims.size());
+    const Grid::InsideBox inBox(_cacheParams.boxMin, _cacheParams.boxMax);
+    const bool           boxEnabled = inBox.Enabled();
+
+    int nChunks = 1;
+#pragma omp parallel
+    {
+#pragma omp single
+        nChunks = omp_get_num_threads();
+    }
+
+    vector<unsigned char> inside(boxEnabled ? nNodes : 0);
+    vector<size_t>        chunkCount(nChunks + 1, 0);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int id = 0; id < nChunks; id++) {
+        const size_t istart = id * nNodes / nChunks;
+        const size_t iend = (id + 1) * nNodes / nChunks;
+
+        if (boxEnabled) {
+            auto      node = grid->ConstNodeBegin() + istart;
+            CoordType coords;
+            size_t    count = 0;
+            for (size_t i = istart; i < iend; ++i, ++node) {
+                grid->GetUserCoordinates(*node, coords);
+                inside[i] = inBox(coords);
+                count += inside[i];
             }
+            chunkCount[id + 1] = count;
+        } else {
+            chunkCount[id + 1] = iend - istart;
+        }
+    }
+
+    for (int id = 0; id < nChunks; id++) chunkCount[id + 1] += chunkCount[id];
+
+    const size_t nInside = chunkCount[nChunks];
+    const size_t nStrided = (nInside + stride - 1) / stride;
+    const size_t budget = _cacheParams.maxParticles > 0 ? (size_t)_cacheParams.maxParticles : nStrided;
+    const size_t nOut = min(nStrided, budget);
+
+    // Strided ordinal s is kept iff floor(s*nOut/nStrided) steps at s, which
+    // keeps exactly nOut evenly spaced particles and places s at that floor.
+    //
+    vector<float> buffer(nOut * nFloats);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int id = 0; id < nChunks; id++) {
+        const size_t istart = id * nNodes / nChunks;
+        const size_t iend = (id + 1) * nNodes / nChunks;
+
+        auto      node = grid->ConstNodeBegin() + istart;
+        CoordType coords;
+        size_t    ordinal = chunkCount[id];
+        for (size_t i = istart; i < iend; ++i, ++node) {
+            if (boxEnabled && !inside[i]) continue;
+            const size_t b = ordinal++;
+            if (b % stride) continue;
+
+            const uint64_t s = b / stride;
+            const uint64_t slot = s * nOut / nStrided;
+            if (nOut < nStrided && (s + 1) * nOut / nStrided == slot) continue;
+
+            float *out = &buffer[slot * nFloats];
+            grid->GetUserCoordinates(*node, coords);
+            *out++ = coords[0];
+            *out++ = coords[1];
+            *out++ = coords[2];
+            if (showDir) {
+                *out++ = vecGrids[0]->GetValueAtIndex(*node);
+                *out++ = vecGrids[1]->GetValueAtIndex(*node);
+                *out++ = vecGrids[2]->GetValueAtIndex(*node);
+            }
+            *out++ = grid->GetValueAtIndex(*node);
+            if (dynamicSize) *out++ = radiusGrid->GetValueAtIndex(*node);
         }
-        step:
-        ++node, ++i;
     }
 
     glBindVertexArray(_VAO);
     glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-    if (dynamicSize) {
-        if (showDir) UploadDataBuffer(directionDynSizeData);
-        else UploadDataBuffer(pointDynSizeData);
-    } else {
-        if (showDir) UploadDataBuffer(directionData);
-        else UploadDataBuffer(pointData);
-    }
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * buffer.size(), buffer.data(), GL_STATIC_DRAW);
+    _particlesCount = nOut;
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -35,6 +35,7 @@ SliceRenderer::SliceRenderer(const ParamsMgr *pm, string winName, string dataSet
 : Renderer(pm, winName, dataSetName, SliceParams::GetClassType(), SliceRenderer::GetClassType(), instanceName, dataMgr)
 {
     _initialized = false;
+    _textureIsCoarse = false;
 
     _windingOrder = {0.0f, 0.0f, 0.f, 1.0f, 0.0f, 0.f, 0.0f, 1.0f, 0.f, 1.0f, 0.0f, 0.f, 1.0f, 1.0f, 0.f, 0.0f, 1.0f, 0.f};
     _rectangle3D = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
@@ -393,7 +394,12 @@ int SliceRenderer::_paintGL(bool fast)
 
     _initializeState();
 
-    if (_isDataCacheDirty() || _isBoxCacheDirty()) {
+    // A coarse slice generated during interaction is refined once
+    // interaction stops, even if nothing else has changed.
+    //
+    bool refine = !fast && _textureIsCoarse;
+
+    if (_isDataCacheDirty() || _isBoxCacheDirty() || refine) {
         _resetCache();
 
         // If we're in fast mode, degrade the quality of the slice for better interactivity
@@ -402,6 +408,7 @@ int SliceRenderer::_paintGL(bool fast)
         } else {
             _textureSideSize = _cacheParams.textureSampleRate;
         }
+        _textureIsCoarse = fast;
 
         int rc = _regenerateSlice();
         if (rc < 0) return -1;
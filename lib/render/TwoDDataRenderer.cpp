@@ -579,6 +579,21 @@ int TwoDDataRenderer::_getMeshStructuredDisplaced(DataMgr *dataMgr, const Struct
     size_t   height = dims[1];
     GLfloat *verts = (GLfloat *)_sb_verts.GetBuf();
     double   mv = hgtGrid->GetMissingValue();
+
+    // If the height variable is sampled on the same horizontal coordinates
+    // as the data variable the height can be read by index instead of
+    // being found by point location.
+    //
+    bool sameCoords = dataMgr->GetVarCoordVars(hgtvar, true) == dataMgr->GetVarCoordVars(rParams->GetVariableName(), true) && hgtGrid->GetDimensions() == dims
+                   && hgtGrid->GetMinAbs() == g->GetMinAbs();
+
+    // Grid caches its user extents lazily, and GetValue() reads them. Fill
+    // the cache here so the parallel lookups below only ever read it.
+    //
+    CoordType minu, maxu;
+    hgtGrid->GetUserExtents(minu, maxu);
+
+#pragma omp parallel for
     for (int j = 0; j < height; j++) {
         for (int i = 0; i < width; i++) {
             double x, y, zdummy;
@@ -589,7 +604,7 @@ int TwoDDataRenderer::_getMeshStructuredDisplaced(DataMgr *dataMgr, const Struct
             // extents are out side of extents for height variable, or if
             // height variable itself contains missing values.
             //
-            double deltaZ = hgtGrid->GetValue(x, y, 0.0);
+            double deltaZ = sameCoords ? hgtGrid->AccessIJK(i, j, 0) : hgtGrid->GetValue(x, y, 0.0);
             if (deltaZ == mv) deltaZ = 0.0;
 
             double z = deltaZ - defaultZ;
@@ -241,6 +241,7 @@ void TwoDRenderer::ComputeNormals(const GLfloat *verts, GLsizei w, GLsizei h, GL
     // Go over the grid of vertices, calculating normals
     // by looking at adjacent x,y,z coords.
     //
+#pragma omp parallel for
     for (int j = 0; j < h; j++) {
         for (int i = 0; i < w; i++) {
             const GLfloat *point = verts + 3 * (i + w * j);
@@ -24,6 +24,8 @@ AnnotationParams *VolumeAlgorithm::GetAnnotationParams() const { return _rendere
 
 Transform *VolumeAlgorithm::GetDatasetTransform() const { return _renderer->GetDatasetTransform(); }
 
+DataMgr *VolumeAlgorithm::GetDataMgr() const { return _renderer->_dataMgr; }
+
 void VolumeAlgorithm::GetExtents(glm::vec3 *dataMin_, glm::vec3 *dataMax_, glm::vec3 *userMin_, glm::vec3 *userMax_) const
 {
     vector<double> minRendererExtents, maxRendererExtents;
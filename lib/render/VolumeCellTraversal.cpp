@@ -7,6 +7,10 @@
 #include <vapor/GLManager.h>
 #include <vapor/ShaderManager.h>
 #include <vapor/Progress.h>
+#include <vapor/CurvilinearGrid.h>
+#include <vapor/DataMgr.h>
+#include <vapor/VolumeParams.h>
+#include <vapor/OpenMPSupport.h>
 
 #ifndef FLT16_MAX
     #define FLT16_MAX 6.55E4
@@ -120,7 +124,9 @@ static bool ComputeSideBBoxes(ivec3 side, int fastDim, int slowDim, vec3 *boxMin
     ivec3 index = (side + 1) / 2 * (cellDims - 1);
     int   sideID = GetFaceIndexFromFace(side);
 
-    for (index[slowDim] = 0; index[slowDim] < cellDims[slowDim]; index[slowDim]++) {
+#pragma omp parallel for firstprivate(index)
+    for (int slow = 0; slow < cellDims[slowDim]; slow++) {
+        index[slowDim] = slow;
         for (index[fastDim] = 0; index[fastDim] < cellDims[fastDim]; index[fastDim]++) {
             vec3 v0, v1, v2, v3;
             GetFaceVertices(index, side, coordData, coordDims, v0, v1, v2, v3);
@@ -132,6 +138,72 @@ static bool ComputeSideBBoxes(ivec3 side, int fastDim, int slowDim, vec3 *boxMin
     return false;
 }
 
+// Copies the node coordinates of grid into data as interleaved xyz triples
+// in i-fastest order. Curvilinear grids are read directly from the blocks
+// of their coordinate grids; other grids fall back to GetUserCoordinates().
+//
+static void GatherCoordinates(const Grid *grid, float *data)
+{
+    const auto   dims = grid->GetDimensions();
+    const size_t w = dims[0], h = dims[1];
+    const long   d = dims[2];
+    const size_t sliceSize = w * h;
+
+    const CurvilinearGrid *cg = dynamic_cast<const CurvilinearGrid *>(grid);
+    if (!cg) {
+#pragma omp parallel for
+        for (long k = 0; k < d; k++) {
+            CoordType coord;
+            float *   p = data + 3 * k * sliceSize;
+            for (size_t j = 0; j < h; j++) {
+                for (size_t i = 0; i < w; i++, p += 3) {
+                    grid->GetUserCoordinates(DimsType{i, j, (size_t)k}, coord);
+                    p[0] = coord[0];
+                    p[1] = coord[1];
+                    p[2] = coord[2];
+                }
+            }
+        }
+        return;
+    }
+
+    // X and Y are the same on every level. Gather level 0 from the 2D
+    // coordinate grids and replicate it.
+    //
+    cg->GetXRG().ForEachBlockRun({0, 0, 0}, {w - 1, h - 1, 0}, [data, w](const float *values, size_t n, const DimsType &index) {
+        float *p = data + 3 * (index[1] * w + index[0]);
+        for (size_t l = 0; l < n; l++) p[3 * l] = values[l];
+    });
+    cg->GetYRG().ForEachBlockRun({0, 0, 0}, {w - 1, h - 1, 0}, [data, w](const float *values, size_t n, const DimsType &index) {
+        float *p = data + 3 * (index[1] * w + index[0]) + 1;
+        for (size_t l = 0; l < n; l++) p[3 * l] = values[l];
+    });
+
+    const bool                 terrainFollowing = cg->IsTerrainFollowing();
+    const std::vector<double> &zcoords = cg->GetZCoords();
+
+#pragma omp parallel for
+    for (long k = 0; k < d; k++) {
+        float *slice = data + 3 * k * sliceSize;
+        if (k > 0) {
+            for (size_t l = 0; l < sliceSize; l++) {
+                slice[3 * l] = data[3 * l];
+                slice[3 * l + 1] = data[3 * l + 1];
+            }
+        }
+
+        if (terrainFollowing) {
+            cg->GetZRG().ForEachBlockRun({0, 0, (size_t)k}, {w - 1, h - 1, (size_t)k}, [data, w, sliceSize](const float *values, size_t n, const DimsType &index) {
+                float *p = data + 3 * (index[2] * sliceSize + index[1] * w + index[0]) + 2;
+                for (size_t l = 0; l < n; l++) p[3 * l] = values[l];
+            });
+        } else {
+            const float z = k < (long)zcoords.size() ? zcoords[k] : 0.f;
+            for (size_t l = 0; l < sliceSize; l++) slice[3 * l + 2] = z;
+        }
+    }
+}
+
 VolumeCellTraversal::VolumeCellTraversal(GLManager *gl, VolumeRenderer *renderer) : VolumeRegular(gl, renderer), _useHighPrecisionTriangleRoutine(false)
 {
     _coordTexture.Generate(GL_NEAREST);
@@ -146,6 +218,51 @@ int VolumeCellTraversal::LoadData(const Grid *grid)
 {
     if (VolumeRegular::LoadData(grid) < 0) return -1;
 
+    if (!_isGeometryCacheDirty(grid)) return 0;
+
+    _geometryCache.valid = false;
+    if (_loadGeometry(grid) < 0) return -1;
+    _saveGeometryCache(grid);
+    return 0;
+}
+
+bool VolumeCellTraversal::_isGeometryCacheDirty(const Grid *grid) const
+{
+    if (!_geometryCache.valid) return true;
+
+    const VolumeParams *p = GetParams();
+    const DataMgr *     dataMgr = GetDataMgr();
+    const std::string   var = p->GetVariableName();
+
+    vector<std::string> coordVars;
+    dataMgr->GetVarCoordVars(var, true, coordVars);
+    if (_geometryCache.coordVars != coordVars) return true;
+    if (_geometryCache.refLevel != p->GetRefinementLevel()) return true;
+    if (_geometryCache.lod != p->GetCompressionLevel()) return true;
+    if (_geometryCache.dims != grid->GetDimensions()) return true;
+    if (_geometryCache.minAbs != grid->GetMinAbs()) return true;
+
+    if (_geometryCache.ts != p->GetCurrentTimestep()) {
+        for (const auto &c : coordVars)
+            if (dataMgr->IsTimeVarying(c)) return true;
+    }
+    return false;
+}
+
+void VolumeCellTraversal::_saveGeometryCache(const Grid *grid)
+{
+    const VolumeParams *p = GetParams();
+    GetDataMgr()->GetVarCoordVars(p->GetVariableName(), true, _geometryCache.coordVars);
+    _geometryCache.ts = p->GetCurrentTimestep();
+    _geometryCache.refLevel = p->GetRefinementLevel();
+    _geometryCache.lod = p->GetCompressionLevel();
+    _geometryCache.dims = grid->GetDimensions();
+    _geometryCache.minAbs = grid->GetMinAbs();
+    _geometryCache.valid = true;
+}
+
+int VolumeCellTraversal::_loadGeometry(const Grid *grid)
+{
     _useHighPrecisionTriangleRoutine = _needsHighPrecisionTriangleRoutine(grid);
     _gridHasInvertedCoordinateSystemHandiness = !grid->HasInvertedCoordinateSystemHandiness();
 
@@ -162,14 +279,8 @@ int VolumeCellTraversal::LoadData(const Grid *grid)
         return -1;
     }
 
-    Progress::Start("Load coord data", nCoords);
-    auto coord = grid->ConstCoordBegin();
-    for (size_t i = 0; i < nCoords; ++i, ++coord) {
-        Progress::Update(i);
-        data[i * 3] = (*coord)[0];
-        data[i * 3 + 1] = (*coord)[1];
-        data[i * 3 + 2] = (*coord)[2];
-    }
+    Progress::Start("Load coord data", 1);
+    GatherCoordinates(grid, data);
     Progress::Finish();
 
     _coordTexture.TexImage(GL_RGB32F, dims[0], dims[1], dims[2], GL_RGB, GL_FLOAT, data);
@@ -266,6 +377,7 @@ int VolumeCellTraversal::LoadData(const Grid *grid)
             if (mUpW == 1) ix = 0;
             if (mUpH == 1) iy = 0;
 
+#pragma omp parallel for
             for (int y = 0; y < mH; y++) {
                 for (int x = 0; x < mW; x++) {
                     vec3 v0 = minMip[level - 1][z * mUpS * mUpS + (y * 2) * mUpS + x * 2];
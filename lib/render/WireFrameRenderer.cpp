@@ -21,6 +21,8 @@
 #include <sstream>
 #include <string>
 #include <iterator>
+#include <algorithm>
+#include <atomic>
 
 #include <vapor/glutil.h>    // Must be included first!!!
 
@@ -35,6 +37,7 @@
 #include "vapor/GLManager.h"
 #include "vapor/debug.h"
 #include <vapor/Progress.h>
+#include <vapor/OpenMPSupport.h>
 
 using namespace VAPoR;
 
@@ -46,11 +49,25 @@ struct WireFrameRenderer::VertexData {
 };
 #pragma pack(pop)
 
+namespace {
+
+// Pack the vertex indices of a line segment into a single key that is
+// independent of the orientation of the segment
+//
+inline uint64_t edgeKey(GLuint idx0, GLuint idx1)
+{
+    if (idx1 < idx0) std::swap(idx0, idx1);
+    return ((uint64_t)idx0 << 32) | idx1;
+}
+
+}    // namespace
+
 static RendererRegistrar<WireFrameRenderer> registrar(WireFrameRenderer::GetClassType(), WireFrameParams::GetClassType());
 
 WireFrameRenderer::WireFrameRenderer(const ParamsMgr *pm, string winName, string dataSetName, string instName, DataMgr *dataMgr)
 : Renderer(pm, winName, dataSetName, WireFrameParams::GetClassType(), WireFrameRenderer::GetClassType(), instName, dataMgr), _VAO(0), _VBO(0), _EBO(0)
 {
+    _topologyCache.valid = false;
 }
 
 WireFrameRenderer::~WireFrameRenderer()
@@ -90,12 +107,39 @@ bool WireFrameRenderer::_isCacheDirty() const
     return false;
 }
 
+void WireFrameRenderer::_saveTopologyCacheParams(const Grid *grid)
+{
+    DC::DataVar datavar;
+    _dataMgr->GetDataVarInfo(_cacheParams.varName, datavar);
+
+    _topologyCache.meshName = datavar.GetMeshName();
+    _topologyCache.gridType = grid->GetType();
+    _topologyCache.dims = grid->GetDimensions();
+    _topologyCache.minAbs = grid->GetMinAbs();
+    _topologyCache.valid = true;
+}
+
+bool WireFrameRenderer::_isTopologyCacheDirty(const Grid *grid) const
+{
+    if (!_topologyCache.valid) return true;
+
+    DC::DataVar datavar;
+    _dataMgr->GetDataVarInfo(_cacheParams.varName, datavar);
+
+    if (_topologyCache.meshName != datavar.GetMeshName()) return true;
+    if (_topologyCache.gridType != grid->GetType()) return true;
+    if (_topologyCache.dims != grid->GetDimensions()) return true;
+    if (_topologyCache.minAbs != grid->GetMinAbs()) return true;
+
+    return false;
+}
+
 //
-// Generate wireframe line drawing list of line segments for a single
-// cell. Make use of drawList to avoid drawing line segments shared
-// by multiple cells
+// Generate the line segments for a single cell as packed pairs of vertex
+// indices (see edgeKey()). Segments shared by multiple cells are emitted
+// once per cell; duplicates are removed by the caller.
 //
-void WireFrameRenderer::_drawCell(const GLuint *cellNodeIndices, int n, bool layered, const vector<GLuint> &nodeMap, GLuint invalidIndex, vector<unsigned int> &indices, DrawList &drawList) const
+void WireFrameRenderer::_cellEdges(const GLuint *cellNodeIndices, int n, bool layered, const vector<GLuint> &nodeMap, GLuint invalidIndex, vector<uint64_t> &edges) const
 {
     int count = layered ? n / 2 : n;
     for (int i = 0; i < count; i++) {
@@ -105,12 +149,7 @@ void WireFrameRenderer::_drawCell(const GLuint *cellNodeIndices, int n, bool lay
         GLuint idx1 = nodeMap[cellNodeIndices[(i + 1) % count]];
         VAssert(idx1 != invalidIndex);
 
-        // Don't draw line segment if it's already been drawn
-        //
-        if (drawList.InList(idx0, idx1)) continue;
-
-        indices.push_back(idx0);
-        indices.push_back(idx1);
+        edges.push_back(edgeKey(idx0, idx1));
     }
 
     if (!layered) return;
@@ -124,10 +163,7 @@ void WireFrameRenderer::_drawCell(const GLuint *cellNodeIndices, int n, bool lay
         GLuint idx1 = nodeMap[cellNodeIndices[((i + 1) % count) + count]];
         VAssert(idx1 != invalidIndex);
 
-        if (drawList.InList(idx0, idx1)) continue;
-
-        indices.push_back(idx0);
-        indices.push_back(idx1);
+        edges.push_back(edgeKey(idx0, idx1));
     }
 
     // Now draw edges between top and bottom face
@@ -139,10 +175,7 @@ void WireFrameRenderer::_drawCell(const GLuint *cellNodeIndices, int n, bool lay
         GLuint idx1 = nodeMap[cellNodeIndices[i + count]];
         VAssert(idx1 != invalidIndex);
 
-        if (drawList.InList(idx0, idx1)) continue;
-
-        indices.push_back(idx0);
-        indices.push_back(idx1);
+        edges.push_back(edgeKey(idx0, idx1));
     }
 }
 
@@ -226,38 +259,48 @@ void WireFrameRenderer::_buildCacheVertices(const Grid *grid, const Grid *height
 //
 size_t WireFrameRenderer::_buildCacheConnectivity(const Grid *grid, const vector<GLuint> &nodeMap, bool *GPUOutOfMemory) const
 {
-    auto             tmp = grid->GetDimensions();
-    auto             dims = std::vector<size_t>{tmp[0], tmp[1], tmp[2]};
-    size_t           invalidIndex = std::numeric_limits<size_t>::max();
-    size_t           numNodes = Wasp::VProduct(dims);
-    bool             layered = grid->GetTopologyDim() == 3;
-    size_t           maxVertsPerCell = grid->GetMaxVertexPerCell();
-    vector<DimsType> cellNodeIndices(maxVertsPerCell);
-    vector<GLuint>   cellNodeIndicesLinear(maxVertsPerCell);
+    GLuint invalidIndex = std::numeric_limits<GLuint>::max();
+    bool   layered = grid->GetTopologyDim() == 3;
+    size_t maxVertsPerCell = grid->GetMaxVertexPerCell();
+    size_t maxEdgesPerCell = layered ? maxVertsPerCell / 2 * 3 : maxVertsPerCell;
 
     size_t numCells = Wasp::VProduct(grid->GetCellDimensions().data(), grid->GetNumCellDimensions());
-    size_t maxLineIndices = numCells * (layered ? maxVertsPerCell / 2 * 3 : maxVertsPerCell * 2);
 
-    // Pre-allocate memory for (much) better performance.
+    // Each thread extracts the edges of a contiguous range of cells, and
+    // removes duplicates within its range. The per-thread lists are then
+    // merged and deduplicated again, so that the resulting list of line
+    // segments (sorted by vertex index) does not depend on the number
+    // of threads.
     //
-    vector<unsigned int> indices;
-    indices.reserve(maxLineIndices);
+    vector<vector<uint64_t>> threadEdges;
+    std::atomic<bool>        cancelled(false);
 
+    Progress::Start("Generate Connectivity", numCells, true);
+#pragma omp parallel
     {
-        // drawList keeps track of line segments that have already been
-        // drawn so that we can avoid duplicates. Avoiding duplicates
-        // reduces the memory requirements substantially
-        //
-        DrawList drawList(numNodes, 10);
-
-        // Loop over cells, drawing edges of each cell
-        //
-        Grid::ConstCellIterator cellItr = grid->ConstCellBegin();
-        Grid::ConstCellIterator cellEnd = grid->ConstCellEnd();
-        Progress::Start("Generate Connectivity", numCells, true);
-        for (int done = 0; cellItr != cellEnd; ++cellItr, ++done) {
-            Progress::Update(done);
-            if (Progress::Cancelled()) return 0;
+        int id = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+
+#pragma omp single
+        threadEdges.resize(nthreads);
+
+        size_t istart = id * numCells / nthreads;
+        size_t iend = (id + 1) * numCells / nthreads;
+        if (id == nthreads - 1) iend = numCells;
+
+        vector<DimsType>  cellNodeIndices(maxVertsPerCell);
+        vector<GLuint>    cellNodeIndicesLinear(maxVertsPerCell);
+        vector<uint64_t> &edges = threadEdges[id];
+        edges.reserve((iend - istart) * maxEdgesPerCell);
+
+        Grid::ConstCellIterator cellItr = grid->ConstCellBegin() + istart;
+        for (size_t done = istart; done < iend && !cancelled; ++cellItr, ++done) {
+            // Only the first thread reports progress, extrapolated to all threads
+            //
+            if (id == 0 && (done % 1024) == 0) {
+                Progress::Update(done * nthreads);
+                if (Progress::Cancelled()) cancelled = true;
+            }
 
             grid->GetCellNodes((*cellItr).data(), cellNodeIndices);
 
@@ -274,8 +317,31 @@ size_t WireFrameRenderer::_buildCacheConnectivity(const Grid *grid, const vector
                 cellNodeIndicesLinear[i] = idx;
             }
 
-            _drawCell(cellNodeIndicesLinear.data(), cellNodeIndices.size(), layered, nodeMap, invalidIndex, indices, drawList);
+            _cellEdges(cellNodeIndicesLinear.data(), cellNodeIndices.size(), layered, nodeMap, invalidIndex, edges);
         }
+
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+    if (cancelled) return 0;
+
+    // Merge the sorted per-thread lists, dropping segments shared by cells
+    // in different ranges
+    //
+    vector<uint64_t> edges = std::move(threadEdges[0]);
+    for (int t = 1; t < threadEdges.size(); t++) {
+        size_t mid = edges.size();
+        edges.insert(edges.end(), threadEdges[t].begin(), threadEdges[t].end());
+        vector<uint64_t>().swap(threadEdges[t]);
+        std::inplace_merge(edges.begin(), edges.begin() + mid, edges.end());
+    }
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    vector<unsigned int> indices(edges.size() * 2);
+#pragma omp parallel for
+    for (long i = 0; i < (long)edges.size(); i++) {
+        indices[2 * i] = (unsigned int)(edges[i] >> 32);
+        indices[2 * i + 1] = (unsigned int)(edges[i] & 0xffffffff);
     }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
@@ -325,7 +391,17 @@ int WireFrameRenderer::_buildCache()
 
     _buildCacheVertices(grid, heightGrid, nodeMap, &_GPUOutOfMemory);
 
-    _nIndices = _buildCacheConnectivity(grid, nodeMap, &_GPUOutOfMemory);
+    // The connectivity only depends on the mesh topology, which usually
+    // does not change from one time step to the next. Reuse it if possible.
+    //
+    if (_isTopologyCacheDirty(grid)) {
+        _topologyCache.valid = false;
+        _nIndices = _buildCacheConnectivity(grid, nodeMap, &_GPUOutOfMemory);
+        if (!Progress::Cancelled() && !_GPUOutOfMemory) _saveTopologyCacheParams(grid);
+    } else {
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
     if (grid) delete grid;
     if (heightGrid) delete heightGrid;
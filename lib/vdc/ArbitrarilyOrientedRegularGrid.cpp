@@ -7,6 +7,7 @@
 #include <GTE/MinimumAreaBox2.h>
 #include <vapor/RegularGrid.h>
 #include <vapor/ArbitrarilyOrientedRegularGrid.h>
+#include <vapor/OpenMPSupport.h>
 
 using namespace std;
 using namespace VAPoR;
@@ -210,9 +211,14 @@ void ArbitrarilyOrientedRegularGrid::_populateData(
     VAPoR::CoordType min = description.boxMin;
     VAPoR::CoordType max = description.boxMax;
     float missingValue = grid->GetMissingValue();
-    size_t index = 0;
 
+    // Each texel is sampled independently, so rows can be filled in
+    // parallel without changing the result. Rows that cross the box
+    // boundary are cheaper than others, hence the dynamic schedule.
+    //
+#pragma omp parallel for schedule(dynamic)
     for (size_t j = 0; j < _sideSize; j++) {
+        size_t index = j * _sideSize;
         for (size_t i = 0; i < _sideSize; i++) {
             VAPoR::CoordType p;
             GetUserCoordinates({i,j,1}, p);
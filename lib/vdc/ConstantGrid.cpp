@@ -13,6 +13,8 @@ float ConstantGrid::GetValueNearestNeighbor(const VAPoR::CoordType &coords) cons
 
 float ConstantGrid::GetValueLinear(const VAPoR::CoordType &coords) const { return _value; }
 
+float ConstantGrid::GetValueAtLocation(const PointLocation &loc) const { return _value; }
+
 std::string ConstantGrid::GetType() const
 {
     std::string type("ConstantGrid");
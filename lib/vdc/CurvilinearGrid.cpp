@@ -408,6 +408,11 @@ float CurvilinearGrid::GetValueNearestNeighbor(const CoordType &coords) const
 
     if (!inside) return (GetMissingValue());
 
+    return (_getValueNearestNeighborQuad(i, j, k, lambda, zwgt));
+}
+
+float CurvilinearGrid::_getValueNearestNeighborQuad(size_t i, size_t j, size_t k, const double lambda[4], const double zwgt[2]) const
+{
     // Find closest point within face
     //
     double maxl = lambda[0];
@@ -495,9 +500,14 @@ float CurvilinearGrid::GetValueLinear(const CoordType &coords) const
     double z = GetGeometryDim() == 3 ? cCoords[2] : 0.0;
     bool   inside = _insideGrid(x, y, z, i, j, k, lambda, zwgt);
 
-    float mv = GetMissingValue();
+    if (!inside) return (GetMissingValue());
 
-    if (!inside) return (mv);
+    return (_getValueQuad(i, j, k, lambda, zwgt));
+}
+
+float CurvilinearGrid::_getValueQuad(size_t i, size_t j, size_t k, const double lambda[4], const double zwgt[2]) const
+{
+    float mv = GetMissingValue();
 
     // Use Wachspress coordinates as weights to do linear interpolation
     // along XY plane
@@ -531,6 +541,28 @@ float CurvilinearGrid::GetValueLinear(const CoordType &coords) const
         return (v0 * zwgt[0] + v1 * zwgt[1]);
 }
 
+void CurvilinearGrid::LocatePoint(const CoordType &coords, PointLocation &loc) const
+{
+    ClampCoord(coords, loc.coords);
+
+    double x = loc.coords[0];
+    double y = loc.coords[1];
+    double z = GetGeometryDim() == 3 ? loc.coords[2] : 0.0;
+    bool   inside = _insideGrid(x, y, z, loc.indices[0], loc.indices[1], loc.indices[2], loc.wgts, loc.zwgt);
+
+    loc.kind = inside ? PointLocation::QUAD : PointLocation::OUTSIDE;
+}
+
+float CurvilinearGrid::GetValueAtLocation(const PointLocation &loc) const
+{
+    if (loc.kind != PointLocation::QUAD || !GetBlks().size()) return (StructuredGrid::GetValueAtLocation(loc));
+
+    const DimsType &idx = loc.indices;
+    if (GetInterpolationOrder() == 0) return (_getValueNearestNeighborQuad(idx[0], idx[1], idx[2], loc.wgts, loc.zwgt));
+
+    return (_getValueQuad(idx[0], idx[1], idx[2], loc.wgts, loc.zwgt));
+}
+
 void CurvilinearGrid::GetUserExtentsHelper(CoordType &minu, CoordType &maxu) const
 {
     // Get the horiztonal (X & Y) extents by visiting every point
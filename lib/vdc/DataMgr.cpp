@@ -1487,6 +1487,60 @@ int DataMgr::GetDataRange(size_t ts, string varname, int level, int lod, CoordTy
     return (0);
 }
 
+int DataMgr::GetBlockDataRanges(size_t ts, string varname, int level, int lod, CoordType min, CoordType max, vector<float> &mins, vector<float> &maxs)
+{
+    SetDiagMsg("DataMgr::GetBlockDataRanges(%d,%s)", ts, varname.c_str());
+
+    mins.clear();
+    maxs.clear();
+
+    int rc = _level_correction(varname, level);
+    if (rc < 0) return (-1);
+
+    rc = _lod_correction(varname, lod);
+    if (rc < 0) return (-1);
+
+    DimsType min_ui, max_ui;
+    rc = _find_bounding_grid(ts, varname, level, lod, min, max, min_ui, max_ui);
+    if (rc != 0) return (-1);
+
+    // See if we've already cache'd it. Ranges are stored as
+    // (min, max) pairs, one per block
+    //
+    ostringstream oss;
+    oss << "VariableBlockRanges";
+    oss << vector_to_string(min_ui);
+    oss << vector_to_string(max_ui);
+    string key = oss.str();
+
+    vector<double> ranges;
+    if (!_varInfoCacheDouble.Get(ts, varname, level, lod, key, ranges)) {
+        const Grid *sg = DataMgr::GetVariable(ts, varname, level, lod, min_ui, max_ui, false);
+        if (!sg) return (-1);
+
+        sg->GetBlockCellRanges(mins, maxs);
+        delete sg;
+
+        ranges.resize(2 * mins.size());
+        for (size_t i = 0; i < mins.size(); i++) {
+            ranges[2 * i] = mins[i];
+            ranges[2 * i + 1] = maxs[i];
+        }
+        _varInfoCacheDouble.Set(ts, varname, level, lod, key, ranges);
+        return (0);
+    }
+
+    VAssert(ranges.size() % 2 == 0);
+    mins.resize(ranges.size() / 2);
+    maxs.resize(ranges.size() / 2);
+    for (size_t i = 0; i < mins.size(); i++) {
+        mins[i] = ranges[2 * i];
+        maxs[i] = ranges[2 * i + 1];
+    }
+
+    return (0);
+}
+
 int DataMgr::GetDimLensAtLevel(string varname, int level, std::vector<size_t> &dims_at_level, std::vector<size_t> &bs_at_level, long ts) const
 {
     VAssert(_dc);
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cassert>
 #include <algorithm>
+#include <limits>
 #include <time.h>
 #ifdef Darwin
     #include <mach/mach_time.h>
@@ -83,6 +84,159 @@ bool interpolate_point_on_edge(const std::array<float, 4> &verts, double xwgt, d
     return (false);
 }
 
+// Min/max accumulator for runs of grid values. Each of the
+// nLanes lanes is reduced independently so that the scan over a run
+// can be vectorized without relying on fast-math reassociation.
+//
+class RangeReducer {
+public:
+    static const size_t nLanes = 8;
+
+    RangeReducer()
+    {
+        std::fill(_lo, _lo + nLanes, std::numeric_limits<float>::infinity());
+        std::fill(_hi, _hi + nLanes, -std::numeric_limits<float>::infinity());
+    }
+
+    // Accumulate all values in the run
+    //
+    void Add(const float *values, size_t n)
+    {
+        float lo[nLanes], hi[nLanes];
+        std::copy(_lo, _lo + nLanes, lo);
+        std::copy(_hi, _hi + nLanes, hi);
+
+        size_t i = 0;
+        for (; i + nLanes <= n; i += nLanes) {
+            for (size_t l = 0; l < nLanes; l++) {
+                float v = values[i + l];
+                lo[l] = v < lo[l] ? v : lo[l];
+                hi[l] = v > hi[l] ? v : hi[l];
+            }
+        }
+        for (; i < n; i++) {
+            float v = values[i];
+            lo[0] = v < lo[0] ? v : lo[0];
+            hi[0] = v > hi[0] ? v : hi[0];
+        }
+
+        std::copy(lo, lo + nLanes, _lo);
+        std::copy(hi, hi + nLanes, _hi);
+    }
+
+    // Accumulate all values in the run that are not equal to \p mv
+    //
+    void Add(const float *values, size_t n, float mv)
+    {
+        float lo[nLanes], hi[nLanes];
+        std::copy(_lo, _lo + nLanes, lo);
+        std::copy(_hi, _hi + nLanes, hi);
+
+        size_t i = 0;
+        for (; i + nLanes <= n; i += nLanes) {
+            for (size_t l = 0; l < nLanes; l++) {
+                float v = values[i + l];
+                bool  ok = v != mv;
+                lo[l] = (ok && v < lo[l]) ? v : lo[l];
+                hi[l] = (ok && v > hi[l]) ? v : hi[l];
+            }
+        }
+        for (; i < n; i++) {
+            float v = values[i];
+            bool  ok = v != mv;
+            lo[0] = (ok && v < lo[0]) ? v : lo[0];
+            hi[0] = (ok && v > hi[0]) ? v : hi[0];
+        }
+
+        std::copy(lo, lo + nLanes, _lo);
+        std::copy(hi, hi + nLanes, _hi);
+    }
+
+    void Merge(const RangeReducer &rhs)
+    {
+        for (size_t l = 0; l < nLanes; l++) {
+            _lo[l] = std::min(_lo[l], rhs._lo[l]);
+            _hi[l] = std::max(_hi[l], rhs._hi[l]);
+        }
+    }
+
+    // Return false if no values were accumulated
+    //
+    bool Get(float &lo, float &hi) const
+    {
+        lo = *std::min_element(_lo, _lo + nLanes);
+        hi = *std::max_element(_hi, _hi + nLanes);
+        return (lo <= hi);
+    }
+
+private:
+    float _lo[nLanes];
+    float _hi[nLanes];
+};
+
+// Regions smaller than this are reduced on a single thread
+//
+const size_t parallelRangeThreshold = 1 << 16;
+
+// Reduce the region bounded by cMin and cMax, which must already be
+// clamped to the grid dimensions. The region is split into planes along
+// its slowest varying non-degenerate axis, and each plane is reduced
+// independently, so the result does not depend on the number of threads.
+//
+bool region_range_reduce(const Grid *g, const DimsType &cMin, const DimsType &cMax, bool checkMissing, float mv, float &lo, float &hi)
+{
+    int    axis = cMax[2] > cMin[2] ? 2 : 1;
+    size_t nPlanes = cMax[axis] - cMin[axis] + 1;
+    size_t nValues = (cMax[0] - cMin[0] + 1) * (cMax[1] - cMin[1] + 1) * (cMax[2] - cMin[2] + 1);
+
+    vector<RangeReducer> partial(nPlanes);
+
+#pragma omp parallel for if (nValues >= parallelRangeThreshold)
+    for (size_t p = 0; p < nPlanes; p++) {
+        DimsType pMin = cMin;
+        DimsType pMax = cMax;
+        pMin[axis] = pMax[axis] = cMin[axis] + p;
+
+        RangeReducer &r = partial[p];
+        if (checkMissing) {
+            g->ForEachBlockRun(pMin, pMax, [&r, mv](const float *values, size_t n, const DimsType &) { r.Add(values, n, mv); });
+        } else {
+            g->ForEachBlockRun(pMin, pMax, [&r](const float *values, size_t n, const DimsType &) { r.Add(values, n); });
+        }
+    }
+
+    RangeReducer r;
+    for (size_t p = 0; p < nPlanes; p++) r.Merge(partial[p]);
+    return (r.Get(lo, hi));
+}
+
+// Compute the range of the values in the clamped region, ignoring
+// any values equal to the missing value. For dataless grids, or regions
+// containing only missing values, the missing value is returned.
+//
+void region_range(const Grid *g, const DimsType &cMin, const DimsType &cMax, float range[2])
+{
+    float mv = g->GetMissingValue();
+    range[0] = range[1] = mv;
+
+    if (!g->GetBlks().size()) return;
+
+    float lo, hi;
+    bool  found = region_range_reduce(g, cMin, cMax, g->HasMissingData(), mv, lo, hi);
+
+    // Values equal to the missing value are excluded even when the grid
+    // is not flagged as having missing data. They can only have affected
+    // the result if they ended up as one of the extremes, in which case
+    // the region is rescanned with the missing value check enabled.
+    //
+    if (found && !g->HasMissingData() && (lo == mv || hi == mv)) { found = region_range_reduce(g, cMin, cMax, true, mv, lo, hi); }
+
+    if (found) {
+        range[0] = lo;
+        range[1] = hi;
+    }
+}
+
 }    // namespace
 
 Grid::Grid() { _dims = {1, 1, 1}; }
@@ -204,56 +358,10 @@ void Grid::SetValueIJK(size_t i, size_t j, size_t k, float v)
 
 void Grid::GetRange(float range[2]) const
 {
-    const auto missingVal = GetMissingValue();
-    const auto num_vals = _dims[0] * _dims[1] * _dims[2];
-    auto num_threads = size_t{1};
-#pragma omp parallel
-    {
-      if (omp_get_thread_num() == 0)
-        num_threads = omp_get_num_threads();
-    }
-    const auto stride_size = num_vals / num_threads;
-
-    auto min_vec = std::vector<float>(num_threads, missingVal);
-    auto max_vec = std::vector<float>(num_threads, missingVal);
-
-#pragma omp parallel for
-    for (size_t i = 0; i < num_threads; i++) {
-      auto beg = this->cbegin() + i * stride_size;
-      auto end = beg;
-      if (i < num_threads - 1) 
-        end += stride_size;
-      else
-        end = this->cend();
-
-      while (*beg == missingVal && beg != end)
-        ++beg;
-
-      if (beg != end) {
-        auto min = *beg;
-        auto max = *beg;
-        for (auto itr  = beg + 1; itr != end; ++itr) {
-          if (*itr != missingVal) {
-            min = std::min(*itr, min);      
-            max = std::max(*itr, max);      
-          }
-        }
-        min_vec[i] = min;
-        max_vec[i] = max;
-      }
-    } // finish omp section
-
-    if (std::all_of(min_vec.begin(), min_vec.end(), 
-        [missingVal](float v){return v == missingVal;})) {
-      range[0] = missingVal;
-      range[1] = missingVal;
-    }
-    else {
-      auto it = std::remove(min_vec.begin(), min_vec.end(), missingVal);
-      range[0] = *std::min_element(min_vec.begin(), it);
-      it = std::remove(max_vec.begin(), max_vec.end(), missingVal);
-      range[1] = *std::max_element(max_vec.begin(), it);
-    }
+    const DimsType &dims = GetDimensions();
+    DimsType        max = {dims[0] - 1, dims[1] - 1, dims[2] - 1};
+
+    region_range(this, {0, 0, 0}, max, range);
 }
 
 void Grid::GetRange(const DimsType &min, const DimsType &max, float range[2]) const
@@ -264,28 +372,60 @@ void Grid::GetRange(const DimsType &min, const DimsType &max, float range[2]) co
     DimsType cMax;
     ClampIndex(max, cMax);
 
+    region_range(this, cMin, cMax, range);
+}
+
+void Grid::GetBlockCellRanges(std::vector<float> &mins, std::vector<float> &maxs) const
+{
+    mins.clear();
+    maxs.clear();
+    if (!_blks.size()) return;
+
+    size_t nBlocks = _bdims[0] * _bdims[1] * _bdims[2];
+    mins.resize(nBlocks);
+    maxs.resize(nBlocks);
+
     float mv = GetMissingValue();
+    bool  checkMissing = HasMissingData();
+
+#pragma omp parallel for schedule(dynamic)
+    for (long b = 0; b < (long)nBlocks; b++) {
+        DimsType bcoord = {b % _bdims[0], (b / _bdims[0]) % _bdims[1], b / (_bdims[0] * _bdims[1])};
+
+        // Include the first node layer of the next block so that every
+        // node of a cell starting in this block is accounted for
+        //
+        DimsType cMin, cMax;
+        for (int i = 0; i < 3; i++) {
+            cMin[i] = bcoord[i] * _bs[i];
+            cMax[i] = std::min((bcoord[i] + 1) * _bs[i], _dims[i] - 1);
+        }
 
-    range[0] = range[1] = mv;
+        RangeReducer r;
+        ForEachBlockRun(cMin, cMax, [&r, checkMissing, mv](const float *values, size_t n, const DimsType &) {
+            if (checkMissing)
+                r.Add(values, n, mv);
+            else
+                r.Add(values, n);
+        });
+
+        float lo, hi;
+        bool  found = r.Get(lo, hi);
+
+        // See region_range() for why this rescan is needed
+        //
+        if (found && !checkMissing && (lo == mv || hi == mv)) {
+            RangeReducer rm;
+            ForEachBlockRun(cMin, cMax, [&rm, mv](const float *values, size_t n, const DimsType &) { rm.Add(values, n, mv); });
+            found = rm.Get(lo, hi);
+        }
 
-    bool first = true;
-    for (size_t k = cMin[2]; k <= cMax[2]; k++) {
-        for (size_t j = cMin[1]; j <= cMax[1]; j++) {
-            for (size_t i = cMin[0]; i <= cMax[0]; i++) {
-                float v = AccessIJK(i, j, k);
-                if (first && v != mv) {
-                    range[0] = range[1] = v;
-                    first = false;
-                }
-
-                if (!first) {
-                    if (v < range[0] && v != mv)
-                        range[0] = v;
-                    else if (v > range[1] && v != mv)
-                        range[1] = v;
-                }
-            }
+        if (!found) {
+            lo = std::numeric_limits<float>::max();
+            hi = std::numeric_limits<float>::lowest();
         }
+        mins[b] = lo;
+        maxs[b] = hi;
     }
 }
 
@@ -305,6 +445,33 @@ float Grid::GetValue(const CoordType &coords) const
     }
 }
 
+void Grid::LocatePoint(const CoordType &coords, PointLocation &loc) const
+{
+    ClampCoord(coords, loc.coords);
+    loc.kind = PointLocation::COORDS;
+}
+
+float Grid::GetValueAtLocation(const PointLocation &loc) const
+{
+    if (!_blks.size()) return (GetMissingValue());
+
+    switch (loc.kind) {
+    case PointLocation::CELL: {
+        if (GetInterpolationOrder() != 0) { return (TrilinearInterpolate(loc.indices[0], loc.indices[1], loc.indices[2], loc.wgts[0], loc.wgts[1], loc.wgts[2])); }
+
+        // Weights are for the node with the smaller index along each axis
+        //
+        DimsType indices = loc.indices;
+        for (int i = 0; i < 3; i++) {
+            if (loc.wgts[i] < 0.5 && indices[i] + 1 < _dims[i]) indices[i]++;
+        }
+        return (AccessIJK(indices[0], indices[1], indices[2]));
+    }
+    case PointLocation::COORDS: return (GetValue(loc.coords));
+    default: return (GetMissingValue());
+    }
+}
+
 
 void Grid::GetUserCoordinates(size_t i, double &x, double &y, double &z) const
 {
@@ -10,32 +10,110 @@
 using namespace std;
 using namespace VAPoR;
 
-KDTreeRG::KDTreeRG(const Grid &xg, const Grid &yg) : _points(xg, yg), _kdtree(2 /* dimension */, _points, nanoflann::KDTreeSingleIndexAdaptorParams(20 /* max leaf num */))
+KDTreeRG::PointCloud::PointCloud(const vector<const Grid *> &coordGrids)
 {
+    VAssert(coordGrids.size() == 2 || coordGrids.size() == 3);
+
+    _nCoords = coordGrids.size();
+
+    const DimsType &dims = coordGrids[0]->GetDimensions();
+    for (int c = 1; c < _nCoords; c++) { VAssert(coordGrids[c]->GetDimensions() == dims); }
+
+    size_t nelem = dims[0] * dims[1] * dims[2];
+    _coords.resize(nelem * _nCoords);
+
+    // Store the point coordinates in the k-d tree, interleaved. Block runs
+    // are visited out of raster order so the destination offset is
+    // computed from the index of the first element in each run
+    //
+    for (int c = 0; c < _nCoords; c++) {
+        float *coords = _coords.data();
+        int    nCoords = _nCoords;
+        coordGrids[c]->ForEachBlockRun([coords, nCoords, c, &dims](const float *values, size_t n, const DimsType &index) {
+            float *dst = coords + (index[0] + dims[0] * (index[1] + dims[1] * index[2])) * nCoords + c;
+            for (size_t i = 0; i < n; i++) { dst[i * nCoords] = values[i]; }
+        });
+    }
+}
+
+KDTreeRG::KDTreeRG(const Grid &xg, const Grid &yg) : _points({&xg, &yg})
+{
+    VAssert(xg.GetNumDimensions() <= 2);
+
     auto tmp = xg.GetDimensions();
     _dims = {tmp[0], tmp[1], tmp[2]};
     _dims.resize(xg.GetNumDimensions());
-    _kdtree.buildIndex();
+
+    _kdtree2D.reset(new KDTreeType2D(2 /* dimension */, _points, nanoflann::KDTreeSingleIndexAdaptorParams(20 /* max leaf num */)));
+    _kdtree2D->buildIndex();
+}
+
+KDTreeRG::KDTreeRG(const Grid &xg, const Grid &yg, const Grid &zg) : _points({&xg, &yg, &zg})
+{
+    auto tmp = xg.GetDimensions();
+    _dims = {tmp[0], tmp[1], tmp[2]};
+    _dims.resize(xg.GetNumDimensions());
+
+    _kdtree3D.reset(new KDTreeType3D(3 /* dimension */, _points, nanoflann::KDTreeSingleIndexAdaptorParams(20 /* max leaf num */)));
+    _kdtree3D->buildIndex();
 }
 
 KDTreeRG::~KDTreeRG() {}
 
+void KDTreeRG::_nearest(const float *coordu, size_t k, size_t *indices, float *distances) const
+{
+    nanoflann::KNNResultSet<float, size_t> resultSet(k);
+    resultSet.init(indices, distances);
+
+    bool rt;
+    if (_kdtree2D) {
+        rt = _kdtree2D->findNeighbors(resultSet, coordu, nanoflann::SearchParams());
+    } else {
+        rt = _kdtree3D->findNeighbors(resultSet, coordu, nanoflann::SearchParams());
+    }
+    VAssert(rt);
+}
+
 void KDTreeRG::Nearest(const vector<float> &coordu, vector<size_t> &coord) const
 {
-    VAssert(coordu.size() == 2);    // 3D case isn't supported yet
+    VAssert(coordu.size() == GetNumCoords());
 
-    size_t                                 ret_index;
-    float                                  dist_sqr;
-    nanoflann::KNNResultSet<float, size_t> resultSet(1);
-    resultSet.init(&ret_index, &dist_sqr);
-    bool rt = _kdtree.findNeighbors(resultSet, coordu.data(), nanoflann::SearchParams());
-    VAssert(rt);
+    size_t ret_index;
+    float  dist_sqr;
+    _nearest(coordu.data(), 1, &ret_index, &dist_sqr);
 
     // De-serialize the linear offset and put it back in vector form
     coord.clear();
     coord = Wasp::VectorizeCoords(ret_index, _dims);
 }
 
+void KDTreeRG::Nearest(const vector<double> &coordu, vector<size_t> &coord) const
+{
+    VAssert(coordu.size() == GetNumCoords());
+
+    // Convert on the stack to avoid a heap allocation per query
+    //
+    float coordu_f[3];
+    for (int i = 0; i < coordu.size(); i++) coordu_f[i] = coordu[i];
+
+    size_t ret_index;
+    float  dist_sqr;
+    _nearest(coordu_f, 1, &ret_index, &dist_sqr);
+
+    coord.clear();
+    coord = Wasp::VectorizeCoords(ret_index, _dims);
+}
+
+void KDTreeRG::Nearest(const float *coordu, size_t n, size_t k, size_t *indices, float *distances) const
+{
+    VAssert(k >= 1 && k <= GetNumPoints());
+
+    const int nCoords = GetNumCoords();
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (size_t i = 0; i < n; i++) { _nearest(coordu + i * nCoords, k, indices + i * k, distances + i * k); }
+}
+
 KDTreeRGSubset::KDTreeRGSubset()
 {
     _kdtree = NULL;
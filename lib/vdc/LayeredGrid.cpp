@@ -233,6 +233,28 @@ float LayeredGrid::GetValue(const CoordType &coords) const
     return _getValueQuadratic(cCoords.data());
 }
 
+void LayeredGrid::LocatePoint(const CoordType &coords, PointLocation &loc) const
+{
+    ClampCoord(coords, loc.coords);
+
+    bool found = _insideGrid(loc.coords, loc.indices, loc.wgts);
+    loc.kind = found ? PointLocation::CELL : PointLocation::OUTSIDE;
+}
+
+float LayeredGrid::GetValueAtLocation(const PointLocation &loc) const
+{
+    // Quadratic interpolation has its own search. It only needs the
+    // coordinates. Pick the order the same way GetValue() does
+    //
+    int interp_order = _interpolationOrder;
+    if (interp_order == 2) {
+        if (GetDimensions()[2] < 3) interp_order = 1;
+    }
+    if (interp_order > 1) return _getValueQuadratic(loc.coords.data());
+
+    return (StructuredGrid::GetValueAtLocation(loc));
+}
+
 void LayeredGrid::SetInterpolationOrder(int order)
 {
     if (order < 0 || order > 3) order = 2;
@@ -23,12 +23,18 @@ Proj4API::Proj4API()
         setenv("PROJ_LIB", path.c_str(), 1);
 #endif
     }
+
+    // A context of its own, rather than proj4's shared default context,
+    // lets objects be used from different threads at once.
+    //
+    _pjCtx = pj_ctx_alloc();
 }
 
 Proj4API::~Proj4API()
 {
     if (_pjSrc) pj_free(_pjSrc);
     if (_pjDst) pj_free(_pjDst);
+    if (_pjCtx) pj_ctx_free((projCtx)_pjCtx);
 }
 
 int Proj4API::_Initialize(string srcdef, string dstdef, void **pjSrc, void **pjDst) const
@@ -37,17 +43,17 @@ int Proj4API::_Initialize(string srcdef, string dstdef, void **pjSrc, void **pjD
     *pjDst = NULL;
 
     if (!srcdef.empty()) {
-        *pjSrc = pj_init_plus(srcdef.c_str());
+        *pjSrc = pj_init_plus_ctx((projCtx)_pjCtx, srcdef.c_str());
         if (!*pjSrc) {
-            SetErrMsg("pj_init_plus(%s) : %s", srcdef.c_str(), ProjErr().c_str());
+            SetErrMsg("pj_init_plus_ctx(%s) : %s", srcdef.c_str(), ProjErr().c_str());
             return (-1);
         }
     }
 
     if (!dstdef.empty()) {
-        *pjDst = pj_init_plus(dstdef.c_str());
+        *pjDst = pj_init_plus_ctx((projCtx)_pjCtx, dstdef.c_str());
         if (!*pjDst) {
-            SetErrMsg("pj_init_plus(%s) : %s", dstdef.c_str(), ProjErr().c_str());
+            SetErrMsg("pj_init_plus_ctx(%s) : %s", dstdef.c_str(), ProjErr().c_str());
             return (-1);
         }
     }
@@ -242,7 +248,7 @@ int Proj4API::Transform(string srcdef, string dstdef, float *x, float *y, float
     return (0);
 }
 
-string Proj4API::ProjErr() const { return (pj_strerrno(*pj_get_errno_ref())); }
+string Proj4API::ProjErr() const { return (pj_strerrno(pj_ctx_get_errno((projCtx)_pjCtx))); }
 
 void Proj4API::Clamp(double *x, double *y, size_t n, int offset) const
 {
@@ -157,6 +157,27 @@ float RegularGrid::GetValueLinear(const CoordType &coords) const
     return (TrilinearInterpolate(i, j, k, xwgt, ywgt, zwgt));
 }
 
+void RegularGrid::LocatePoint(const CoordType &coords, PointLocation &loc) const
+{
+    ClampCoord(coords, loc.coords);
+    const CoordType &cCoords = loc.coords;
+
+    loc.kind = PointLocation::OUTSIDE;
+    if (!InsideGrid(cCoords)) return;
+
+    DimsType &idx = loc.indices;
+    idx = {0, 0, 0};
+    for (int d = 0; d < 3; d++) {
+        loc.wgts[d] = 0.0;
+        if (_delta[d] == 0.0) continue;
+
+        idx[d] = (size_t)floor((cCoords[d] - _minu[d]) / _delta[d]);
+        loc.wgts[d] = 1.0 - (((cCoords[d] - _minu[d]) - (idx[d] * _delta[d])) / _delta[d]);
+    }
+
+    loc.kind = PointLocation::CELL;
+}
+
 void RegularGrid::GetUserExtentsHelper(CoordType &minu, CoordType &maxu) const
 {
     minu = _minu;
@@ -282,6 +282,18 @@ float StretchedGrid::GetValueLinear(const CoordType &coords) const
     return (TrilinearInterpolate(i, j, k, wgts[0], wgts[1], wgts[2]));
 }
 
+void StretchedGrid::LocatePoint(const CoordType &coords, PointLocation &loc) const
+{
+    ClampCoord(coords, loc.coords);
+
+    double x = loc.coords[0];
+    double y = loc.coords[1];
+    double z = GetGeometryDim() == 3 ? loc.coords[2] : 0.0;
+    bool   inside = _insideGrid(x, y, z, loc.indices[0], loc.indices[1], loc.indices[2], loc.wgts[0], loc.wgts[1], loc.wgts[2]);
+
+    loc.kind = inside ? PointLocation::CELL : PointLocation::OUTSIDE;
+}
+
 void StretchedGrid::GetUserExtentsHelper(CoordType &minext, CoordType &maxext) const
 {
     auto dims = StructuredGrid::GetDimensions();
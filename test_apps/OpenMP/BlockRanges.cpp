@@ -0,0 +1,166 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include <random>
+#include <array>
+#include <algorithm>
+
+#include "vapor/RegularGrid.h"
+#include "vapor/OpenMPSupport.h"
+
+// Allocate a bunch of raw pointers.
+// The caller will need to delete[] them.
+//
+auto AllocateBlocks(std::array<size_t, 3> bs, std::array<size_t, 3> dims) -> std::vector<float*>
+{
+    size_t block_size = 1;
+    size_t nblocks = 1;
+
+    for (size_t i = 0; i < bs.size(); i++) {
+        block_size *= bs[i];
+        nblocks *= ((dims[i] - 1) / bs[i]) + 1;
+    }
+
+    auto blks = std::vector<float*>(nblocks, nullptr);
+    for (size_t i = 0; i < nblocks; i++)
+      blks[i] = new float[block_size];
+
+    return (blks);
+}
+
+// Check that, for every isovalue, each cell containing a crossing (an edge
+// with one node <= iso and the other > iso) lies in a block whose range
+// passes the culling test of Grid::GetBlockCellRanges(). Also report how
+// many blocks the index lets us skip.
+//
+bool CheckCulling(const VAPoR::Grid* g, const std::vector<float>& isovalues, const char* label)
+{
+  std::vector<float> mins, maxs;
+  const auto start = std::chrono::steady_clock::now();
+  g->GetBlockCellRanges(mins, maxs);
+  const auto end = std::chrono::steady_clock::now();
+  const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+  std::cout << label << " GetBlockCellRanges() time (milliseconds): " << time << std::endl;
+
+  const auto bs = g->GetBlockSize();
+  const auto bdims = g->GetDimensionInBlks();
+  const auto cdims = g->GetCellDimensions();
+  const float mv = g->GetMissingValue();
+
+  if (mins.size() != bdims[0] * bdims[1] * bdims[2]) {
+    std::printf("FAIL : %s block count mismatch %ld vs %ld\n", label, mins.size(), bdims[0] * bdims[1] * bdims[2]);
+    return false;
+  }
+
+  size_t nCrossings = 0, nDropped = 0, nCulled = 0;
+  for (float iso : isovalues) {
+    for (size_t b = 0; b < mins.size(); b++)
+      if (iso < mins[b] || iso >= maxs[b]) nCulled++;
+
+    std::vector<VAPoR::DimsType> nodes;
+    for (size_t k = 0; k < cdims[2]; k++) {
+      for (size_t j = 0; j < cdims[1]; j++) {
+        for (size_t i = 0; i < cdims[0]; i++) {
+          g->GetCellNodes(VAPoR::DimsType{i, j, k}, nodes);
+
+          float lo = 0.0, hi = 0.0;
+          bool hasMissing = false;
+          for (size_t n = 0; n < nodes.size(); n++) {
+            float v = g->GetValueAtIndex(nodes[n]);
+            if (v == mv) hasMissing = true;
+            lo = n ? std::min(lo, v) : v;
+            hi = n ? std::max(hi, v) : v;
+          }
+          // The cell's nodes are connected, so a crossing exists iff
+          // lo <= iso < hi
+          //
+          if (hasMissing || !(lo <= iso && iso < hi)) continue;
+          nCrossings++;
+
+          size_t b = i / bs[0] + bdims[0] * (j / bs[1] + bdims[1] * (k / bs[2]));
+          if (iso < mins[b] || iso >= maxs[b]) nDropped++;
+        }
+      }
+    }
+  }
+
+  std::printf("%s: %ld crossing cells, %ld of %ld block tests culled\n", label, nCrossings, nCulled, mins.size() * isovalues.size());
+  if (nDropped)
+    std::printf("FAIL : %s culling dropped %ld crossing cells\n", label, nDropped);
+  return nDropped == 0;
+}
+
+bool TestGrid(std::array<size_t, 3> dims, std::array<size_t, 3> blk_size, std::mt19937& gen, const char* label)
+{
+  auto blks = AllocateBlocks(blk_size, dims);
+  auto* grid = new VAPoR::RegularGrid(dims, blk_size, blks, {0.0, 0.0, 0.0}, {100.0, 100.0, 100.0});
+
+  // A smooth field plus noise, so that most blocks span only part of the
+  // value range
+  //
+  std::uniform_real_distribution<float> noise(-0.5, 0.5);
+  for (size_t k = 0; k < dims[2]; k++)
+    for (size_t j = 0; j < dims[1]; j++)
+      for (size_t i = 0; i < dims[0]; i++)
+        grid->SetValueIJK(i, j, k, 0.1 * i + 0.05 * j + 0.02 * k + noise(gen));
+
+  std::vector<float> isovalues;
+  float range[2];
+  grid->GetRange(range);
+  std::uniform_real_distribution<float> isoDist(range[0], range[1]);
+  for (int i = 0; i < 20; i++) isovalues.push_back(isoDist(gen));
+
+  // Values that are exactly equal to node values are the edge case of
+  // the half-open crossing test
+  //
+  isovalues.push_back(grid->AccessIJK(dims[0] / 2, dims[1] / 2, dims[2] / 2));
+  isovalues.push_back(grid->AccessIJK(blk_size[0], 0, 0));
+
+  bool pass = CheckCulling(grid, isovalues, label);
+
+  // Sprinkle missing values and repeat
+  //
+  const float missingVal = -1000.0;
+  grid->SetMissingValue(missingVal);
+  grid->SetHasMissingValues(true);
+  std::uniform_int_distribution<size_t> idx(0, dims[0] * dims[1] * dims[2] - 1);
+  for (size_t i = 0; i < dims[0] * dims[1] * dims[2] / 50; i++) {
+    size_t l = idx(gen);
+    grid->SetValueIJK(l % dims[0], (l / dims[0]) % dims[1], l / (dims[0] * dims[1]), missingVal);
+  }
+
+  std::string mlabel = std::string(label) + " with missing values";
+  pass &= CheckCulling(grid, isovalues, mlabel.c_str());
+
+  delete grid;
+  for (size_t i = 0; i < blks.size(); i++)
+    delete[](blks[i]);
+
+  return pass;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::cout << "Help:  This program checks that the per-block cell value ranges\n"
+                 "       returned by Grid::GetBlockCellRanges() never cull a block that\n"
+                 "       contains an isovalue crossing, for a 3D grid of size\n"
+                 "       (Dim x Dim x Dim) and a 2D grid of size (4*Dim x 4*Dim).\n"
+                 "Note:  the environment variable OMP_NUM_THREADS controls the number of threads.\n"
+                 "Usage: ./BlockRanges Dim\n";
+    return 1;
+  }
+  const size_t dim = std::stol(argv[1]);
+
+  std::mt19937 gen(12345);
+
+  // Dimensions that are not multiples of the block size
+  //
+  bool pass = TestGrid({dim, dim + 3, dim + 7}, {32, 32, 32}, gen, "3D");
+  pass &= TestGrid({4 * dim + 5, 4 * dim + 1, 1}, {64, 64, 1}, gen, "2D");
+
+  std::cout << (pass ? "Block range culling is conservative" : "FAIL : block range culling dropped crossings") << std::endl;
+
+  return pass ? 0 : 1;
+}
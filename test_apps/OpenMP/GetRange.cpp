@@ -53,6 +53,62 @@ void GetRange_36(VAPoR::Grid* g, float range[2])
     }
 }
 
+// Copy of Grid::GetRange(min, max) function from VAPOR release 3.9
+//
+void GetRange_39(const VAPoR::Grid* g, const VAPoR::DimsType& min, const VAPoR::DimsType& max, float range[2])
+{
+    float mv = g->GetMissingValue();
+
+    range[0] = range[1] = mv;
+
+    bool first = true;
+    for (size_t k = min[2]; k <= max[2]; k++) {
+        for (size_t j = min[1]; j <= max[1]; j++) {
+            for (size_t i = min[0]; i <= max[0]; i++) {
+                float v = g->AccessIJK(i, j, k);
+                if (first && v != mv) {
+                    range[0] = range[1] = v;
+                    first = false;
+                }
+
+                if (!first) {
+                    if (v < range[0] && v != mv)
+                        range[0] = v;
+                    else if (v > range[1] && v != mv)
+                        range[1] = v;
+                }
+            }
+        }
+    }
+}
+
+// Time the serial region GetRange() against the current implementation and
+// check that both produce identical results
+//
+bool CompareRegionRange(const VAPoR::Grid* g, const VAPoR::DimsType& min, const VAPoR::DimsType& max, const char* label)
+{
+  float range_39[2] = {0.0, 1.1};
+  const auto serial_start = std::chrono::steady_clock::now();
+  GetRange_39(g, min, max, range_39);
+  const auto serial_end = std::chrono::steady_clock::now();
+  const auto serial_time = std::chrono::duration_cast<std::chrono::milliseconds>(serial_end - serial_start).count();
+
+  float range_omp[2] = {2.2, 3.3};
+  const auto omp_start = std::chrono::steady_clock::now();
+  g->GetRange(min, max, range_omp);
+  const auto omp_end = std::chrono::steady_clock::now();
+  const auto omp_time = std::chrono::duration_cast<std::chrono::milliseconds>(omp_end - omp_start).count();
+
+  std::cout << label << " region GetRange() serial time (milliseconds): " << serial_time << std::endl;
+  std::cout << label << " region GetRange() OpenMP time (milliseconds): " << omp_time << std::endl;
+
+  bool match = range_39[0] == range_omp[0] && range_39[1] == range_omp[1];
+  if (!match)
+    std::printf("FAIL : %s region range mismatch (%f, %f) vs (%f, %f)\n", label,
+                range_39[0], range_39[1], range_omp[0], range_omp[1]);
+  return match;
+}
+
 int main(int argc, char* argv[])
 {
   if (argc != 2) {
@@ -113,6 +169,34 @@ int main(int argc, char* argv[])
   const auto omp_time = std::chrono::duration_cast<std::chrono::milliseconds>(omp_end - omp_start).count();
   std::cout << "GetRange() in OpenMP time (milliseconds): " << omp_time << std::endl;
 
+  bool pass = range_36[0] == range_omp[0] && range_36[1] == range_omp[1];
+  if (!pass)
+    std::printf("FAIL : range mismatch (%f, %f) vs (%f, %f)\n", range_36[0], range_36[1], range_omp[0], range_omp[1]);
+
+  // Regions: the full grid and a sub-region that is not block aligned
+  //
+  const auto full_min = VAPoR::DimsType{0, 0, 0};
+  const auto full_max = VAPoR::DimsType{dim - 1, dim - 1, dim - 1};
+  const auto sub_min = VAPoR::DimsType{dim / 5, dim / 3, dim / 7};
+  const auto sub_max = VAPoR::DimsType{dim - 1 - dim / 3, dim - 1 - dim / 4, dim - 1 - dim / 6};
+
+  pass &= CompareRegionRange(grid, full_min, full_max, "Full");
+  pass &= CompareRegionRange(grid, sub_min, sub_max, "Sub");
+
+  // Sprinkle missing values, including at the extremes, and repeat
+  //
+  const float missingVal = -1.0;
+  grid->SetMissingValue(missingVal);
+  grid->SetHasMissingValues(true);
+  std::uniform_int_distribution<size_t> idx(0, dim - 1);
+  for (size_t i = 0; i < dim * dim; i++)
+    grid->SetValueIJK(idx(gen), idx(gen), idx(gen), missingVal);
+
+  pass &= CompareRegionRange(grid, full_min, full_max, "Missing value full");
+  pass &= CompareRegionRange(grid, sub_min, sub_max, "Missing value sub");
+
+  std::cout << (pass ? "GetRange() results match" : "FAIL : GetRange() results differ") << std::endl;
+
   // Clean up
   delete grid;
   grid = nullptr;
@@ -121,5 +205,5 @@ int main(int argc, char* argv[])
     blks[i] = nullptr;
   }
 
-  return 0;
+  return pass ? 0 : 1;
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "vapor/Field.h"
+#include "vapor/OpenMPSupport.h"
+
+// Forwards to another field, counts how many times the velocity is evaluated,
+// and records the time windows that are prepared.
+// Each thread counts into its own cache line, so counting does not serialize the
+// threads that are being measured.
+//
+class CountingField : public flow::Field {
+public:
+    struct Window {
+        double t0, t1;
+        bool   prefetchNext;
+    };
+
+    explicit CountingField(const flow::Field &field) : _field(field)
+    {
+        IsSteady = field.IsSteady;
+        Reset();
+    }
+
+    // Call before each advection, after the number of threads is set
+    void Reset()
+    {
+        _counters.assign(omp_get_max_threads(), Counter());
+        _windows.clear();
+    }
+
+    long Evaluations() const
+    {
+        long n = 0;
+        for (const auto &c : _counters) n += c.n;
+        return n;
+    }
+
+    const std::vector<Window> &PreparedWindows() const { return _windows; }
+
+    bool                InsideVolumeVelocity(double time, glm::vec3 pos) const override { return _field.InsideVolumeVelocity(time, pos); }
+    bool                InsideVolumeScalar(double time, glm::vec3 pos) const override { return _field.InsideVolumeScalar(time, pos); }
+    uint32_t            GetNumberOfTimesteps() const override { return _field.GetNumberOfTimesteps(); }
+    std::vector<double> GetTimestamps() const override { return _field.GetTimestamps(); }
+    int                 PrepareTimeWindow(double t0, double t1, bool prefetchNext = false) const override
+    {
+        _windows.push_back({t0, t1, prefetchNext});
+        return _field.PrepareTimeWindow(t0, t1, prefetchNext);
+    }
+    void                FinishTimeWindows() const override { _field.FinishTimeWindows(); }
+    int                 GetScalar(double time, glm::vec3 pos, float &val) const override { return _field.GetScalar(time, pos, val); }
+    int                 LockParams() override { return 0; }
+    int                 UnlockParams() override { return 0; }
+
+    int GetVelocity(double time, glm::vec3 pos, glm::vec3 &vel) const override
+    {
+        _counters[omp_get_thread_num()].n++;
+        return _field.GetVelocity(time, pos, vel);
+    }
+
+private:
+    struct alignas(64) Counter {
+        long n = 0;
+    };
+
+    const flow::Field &          _field;
+    mutable std::vector<Counter> _counters;
+    mutable std::vector<Window>  _windows;
+};
@@ -0,0 +1,179 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <random>
+
+#include "vapor/Advection.h"
+#include "vapor/AnalyticField.h"
+#include "vapor/OpenMPSupport.h"
+#include "CountingField.h"
+
+using flow::Advection;
+using flow::Particle;
+using GridType = flow::SampledField::GRID_TYPE;
+
+// A benchmark case: an analytic field, seeds in it, and how far to advect them.
+//
+struct Case {
+    const char *               label;
+    const flow::AnalyticField &field;
+    std::vector<Particle>      seeds;
+    double                     T, deltaT;
+    std::vector<double>        timestamps;    // where the sampled fields are sampled in time
+    VAPoR::DimsType            dims;          // grid dimensions of the sampled fields
+    bool                       periodic;      // in all dimensions, over the domain
+};
+
+struct Result {
+    std::vector<Particle> ends;    // a zero time marks streams that left the volume
+    long                  steps = 0, evaluations = 0;
+    double                seconds = 0.0;
+};
+
+// Advect the seeds from time 0 to time T with fixed RK4 steps.
+//
+Result Advect(const Case &c, const flow::Field &field, const std::vector<Particle> &seeds, double deltaT)
+{
+    CountingField counted(field);
+    Advection     adv;
+    adv.UseSeedParticles(seeds);
+    if (c.periodic) {
+        glm::vec3 minu, maxu;
+        c.field.GetDomain(minu, maxu);
+        adv.SetXPeriodicity(true, minu.x, maxu.x);
+        adv.SetYPeriodicity(true, minu.y, maxu.y);
+        adv.SetZPeriodicity(true, minu.z, maxu.z);
+    }
+
+    Result r;
+    counted.Reset();
+    const auto start = std::chrono::steady_clock::now();
+    adv.AdvectTillTime(&counted, 0.0, deltaT, c.T, true);
+    const auto end = std::chrono::steady_clock::now();
+    r.seconds = std::chrono::duration<double>(end - start).count();
+    r.evaluations = counted.Evaluations();
+
+    r.ends.resize(seeds.size());
+    for (size_t i = 0; i < seeds.size(); i++) {
+        const auto &s = adv.GetStreamAt(i);
+        long        n = 0;
+        for (const auto &p : s) n += !p.IsSpecial();
+        r.steps += n - 1;
+        if (!s.back().IsSpecial()) r.ends[i] = s.back();
+        else r.ends[i].time = 0.0;
+    }
+    return r;
+}
+
+// Distance between two points, taking the shortest way around periodic dimensions
+//
+double Distance(const Case &c, glm::vec3 a, glm::vec3 b)
+{
+    glm::vec3 minu, maxu;
+    c.field.GetDomain(minu, maxu);
+    double d2 = 0.0;
+    for (int i = 0; i < 3; i++) {
+        double d = std::abs(a[i] - b[i]);
+        if (c.periodic) {
+            double len = maxu[i] - minu[i];
+            d = std::fmod(d, len);
+            d = std::min(d, len - d);
+        }
+        d2 += d * d;
+    }
+    return std::sqrt(d2);
+}
+
+void Run(const Case &c, const std::vector<int> &threadCounts)
+{
+    std::vector<std::unique_ptr<flow::SampledField>> sampled;
+    for (GridType type : {GridType::REGULAR, GridType::STRETCHED, GridType::LAYERED, GridType::CURVILINEAR}) sampled.emplace_back(new flow::SampledField(c.field, type, c.dims, c.timestamps));
+
+    std::printf("\n%s: T = %g, deltaT = %g, grids of %ld x %ld x %ld\n", c.label, c.T, c.deltaT, c.dims[0], c.dims[1], c.dims[2]);
+    std::printf("%-12s %8s %8s %14s %12s %12s %12s %10s\n", "source", "seeds", "threads", "steps/second", "evaluations", "mean error", "max error", "streams");
+
+    // The reference solution: the analytic field with steps 16 times smaller
+    const Result reference = Advect(c, c.field, c.seeds, c.deltaT / 16.0);
+
+    for (size_t n : {c.seeds.size() / 16, c.seeds.size() / 4, c.seeds.size()}) {
+        if (n == 0) continue;
+        const std::vector<Particle> seeds(c.seeds.begin(), c.seeds.begin() + n);
+
+        for (int s = -1; s < (int)sampled.size(); s++) {
+            const flow::Field &field = s < 0 ? static_cast<const flow::Field &>(c.field) : *sampled[s];
+            const char *       name = s < 0 ? "Analytic" : flow::SampledField::GetGridTypeName(GridType(s));
+
+            for (int threads : threadCounts) {
+                omp_set_num_threads(threads);
+                const Result r = Advect(c, field, seeds, c.deltaT);
+
+                double maxErr = 0.0, sumErr = 0.0;
+                size_t valid = 0;
+                for (size_t i = 0; i < n; i++) {
+                    if (r.ends[i].time != c.T || reference.ends[i].time != c.T) continue;
+                    double err = Distance(c, r.ends[i].location, reference.ends[i].location);
+                    maxErr = std::max(maxErr, err);
+                    sumErr += err;
+                    valid++;
+                }
+                std::printf("%-12s %8ld %8d %14.4g %12ld %12.3e %12.3e %10ld\n", name, n, threads, r.seconds > 0.0 ? r.steps / r.seconds : 0.0, r.evaluations,
+                            valid ? sumErr / valid : 0.0, maxErr, valid);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cout << "Help:  This program measures the advection speed (steps per second), the number of\n"
+                     "       velocity evaluations, and the accuracy against the analytic solution of\n"
+                     "       fixed step RK4 advection in ABC flow, the double gyre, and Hill's spherical\n"
+                     "       vortex. Each field is evaluated analytically, and sampled on regular,\n"
+                     "       stretched, layered and curvilinear grids with about GridDim nodes along\n"
+                     "       each dimension. It uses up to NumSeeds random seeds, and 1, 2, 4, ...\n"
+                     "       threads, up to the number of threads OpenMP would use.\n"
+                     "Usage: ./FlowBenchmark NumSeeds GridDim\n";
+        return 1;
+    }
+    const size_t numSeeds = std::stol(argv[1]);
+    const size_t dim = std::stol(argv[2]);
+
+    std::vector<int> threadCounts;
+    const int        maxThreads = omp_get_max_threads();
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    std::mt19937                          gen(12345);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    {
+        flow::ABCField abc;
+        Case           c{"ABC", abc, {}, 10.0, 0.05, {0.0}, {dim, dim, dim}, true};
+        for (size_t i = 0; i < numSeeds; i++) c.seeds.emplace_back(2.f * M_PI * unit(gen), 2.f * M_PI * unit(gen), 2.f * M_PI * unit(gen), 0.0);
+        Run(c, threadCounts);
+    }
+    {
+        flow::DoubleGyreField gyre;
+        Case                  c{"DoubleGyre", gyre, {}, 20.0, 0.1, {}, {2 * dim, dim, 2}, false};
+        for (double t = 0.0; t <= c.T; t += 0.5) c.timestamps.push_back(t);
+        for (size_t i = 0; i < numSeeds; i++) c.seeds.emplace_back(0.1f + 1.8f * unit(gen), 0.1f + 0.8f * unit(gen), 0.5f, 0.0);
+        Run(c, threadCounts);
+    }
+    {
+        // Seeds inside the vortex, where streamlines are closed
+        flow::HillsVortexField hill;
+        Case                   c{"HillsVortex", hill, {}, 10.0, 0.05, {0.0}, {dim, dim, dim}, false};
+        while (c.seeds.size() < numSeeds) {
+            glm::vec3 p(2.f * unit(gen) - 1.f, 2.f * unit(gen) - 1.f, 2.f * unit(gen) - 1.f);
+            if (glm::length(p) < 0.9f) c.seeds.emplace_back(p, 0.0);
+        }
+        Run(c, threadCounts);
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <random>
+
+#include "vapor/Advection.h"
+#include "vapor/AnalyticField.h"
+#include "CountingField.h"
+
+using flow::ADVECT_HAPPENED;
+using flow::Advection;
+using flow::Particle;
+using Method = flow::Advection::ADVECTION_METHOD;
+
+// Advect all seeds from time 0 to time T, and return the end points of the streams
+// that stayed inside the volume (a zero time marks the others).
+//
+std::vector<Particle> Advect(CountingField &field, const std::vector<Particle> &seeds, double T, double deltaT, bool fixedStepSize, Method method, double relTol, long &evaluations)
+{
+    Advection adv;
+    adv.UseSeedParticles(seeds);
+    adv.SetRK45Tolerance(relTol);
+    field.Reset();
+    adv.AdvectTillTime(&field, 0.0, deltaT, T, fixedStepSize, method);
+    evaluations = field.Evaluations();
+
+    std::vector<Particle> ends(seeds.size());
+    for (size_t i = 0; i < seeds.size(); i++) {
+        const auto &s = adv.GetStreamAt(i);
+        if (!s.back().IsSpecial()) ends[i] = s.back();
+        else ends[i].time = 0.0;
+    }
+    return ends;
+}
+
+void Compare(const char *label, const flow::Field &analytic, const std::vector<Particle> &seeds, double T, double deltaT)
+{
+    CountingField field(analytic);
+    long          evals = 0;
+
+    // The reference solution: RK4 with fixed, small steps. Note that
+    // AdvectTillTime() stops a stream after 10,000 steps.
+    auto reference = Advect(field, seeds, T, deltaT / 16.0, true, Method::RK4, 0.0, evals);
+
+    auto report = [&](const char *name, const std::vector<Particle> &ends, long evals) {
+        double maxErr = 0.0, sumErr = 0.0;
+        size_t n = 0;
+        for (size_t i = 0; i < ends.size(); i++) {
+            if (ends[i].time != T || reference[i].time != T) continue;
+            double err = glm::distance(ends[i].location, reference[i].location);
+            maxErr = std::max(maxErr, err);
+            sumErr += err;
+            n++;
+        }
+        std::printf("%s %-24s evaluations %10ld  mean error %.3e  max error %.3e  (%ld streams)\n", label, name, evals, n ? sumErr / n : 0.0, maxErr, n);
+    };
+
+    std::printf("%s: %ld seeds, T = %g, deltaT = %g\n", label, seeds.size(), T, deltaT);
+    for (double scale : {4.0, 1.0, 0.25}) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "RK4 fixed dt=%g", deltaT * scale);
+        auto ends = Advect(field, seeds, T, deltaT * scale, true, Method::RK4, 0.0, evals);
+        report(name, ends, evals);
+        std::snprintf(name, sizeof(name), "RK4 adaptive dt=%g", deltaT * scale);
+        ends = Advect(field, seeds, T, deltaT * scale, false, Method::RK4, 0.0, evals);
+        report(name, ends, evals);
+    }
+    for (double tol : {1e-2, 1e-3, 1e-4, 1e-5}) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "RK45 relTol=%g", tol);
+        auto ends = Advect(field, seeds, T, deltaT, false, Method::RK45, tol, evals);
+        report(name, ends, evals);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::cout << "Help:  This program compares the number of velocity evaluations and the accuracy\n"
+                     "       of the RK4 and RK45 advection methods on analytic velocity fields,\n"
+                     "       with NumSeeds random seeds in each field.\n"
+                     "Note:  the environment variable OMP_NUM_THREADS controls the number of threads.\n"
+                     "Usage: ./FlowIntegrators NumSeeds\n";
+        return 1;
+    }
+    const size_t numSeeds = std::stol(argv[1]);
+
+    std::mt19937                          gen(12345);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    std::vector<Particle> seeds;
+    for (size_t i = 0; i < numSeeds; i++) seeds.emplace_back(2.f * M_PI * unit(gen), 2.f * M_PI * unit(gen), 2.f * M_PI * unit(gen), 0.0);
+    flow::ABCField abc;
+    Compare("ABC", abc, seeds, 10.0, 0.05);
+
+    seeds.clear();
+    for (size_t i = 0; i < numSeeds; i++) seeds.emplace_back(0.1f + 1.8f * unit(gen), 0.1f + 0.8f * unit(gen), 0.f, 0.0);
+    flow::DoubleGyreField gyre;
+    Compare("DoubleGyre", gyre, seeds, 20.0, 0.1);
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "vapor/Advection.h"
+#include "vapor/GridField.h"
+#include "vapor/RegularGrid.h"
+
+#include "CountingField.h"
+
+using flow::Advection;
+using flow::Particle;
+
+// A uniform flow of velocity (1, 0, 0) in [0, 10]^3, given at the integer
+// times 0 .. nTimesteps-1, so that advection crosses time steps.
+//
+class UniformFlow {
+public:
+    flow::GridField field;
+
+    explicit UniformFlow(int nTimesteps)
+    {
+        const VAPoR::DimsType dims = {4, 4, 4};
+        for (int t = 0; t < nTimesteps; t++) {
+            const VAPoR::Grid *components[3];
+            for (int c = 0; c < 3; c++) {
+                _blocks.emplace_back(new float[64]);
+                std::fill(_blocks.back().get(), _blocks.back().get() + 64, c == 0 ? 1.f : 0.f);
+                _grids.emplace_back(new VAPoR::RegularGrid(dims, dims, {_blocks.back().get()}, {0.0, 0.0, 0.0}, {10.0, 10.0, 10.0}));
+                components[c] = _grids.back().get();
+            }
+            field.AddTimestep(double(t), components[0], components[1], components[2]);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<float[]>>     _blocks;
+    std::vector<std::unique_ptr<VAPoR::Grid>> _grids;
+};
+
+// Fixed steps of 0.1 accumulate to just below the integer time steps. The
+// stream must still reach the end time instead of taking a sliver of a step
+// at a time step, which doesn't move the particle and terminates the stream.
+//
+bool TestFixedStepsAcrossTimesteps()
+{
+    UniformFlow flow(3);
+    bool        pass = true;
+    for (auto method : {Advection::ADVECTION_METHOD::EULER, Advection::ADVECTION_METHOD::RK4, Advection::ADVECTION_METHOD::RK45}) {
+        Advection adv;
+        adv.UseSeedParticles({Particle(1.f, 5.f, 5.f, 0.0)});
+        adv.AdvectTillTime(&flow.field, 0.0, 0.1, 2.0, true, method);
+
+        const auto &s = adv.GetStreamAt(0);
+        const auto &end = s.back();
+        bool        ok = !end.IsSpecial() && end.time == 2.0 && std::abs(end.location.x - 3.f) < 1e-4f;
+        std::printf("Fixed steps across time steps, method %d: %ld samples, end time %g, end x %g\n", int(method), s.size(), end.time, end.location.x);
+        if (!ok) std::printf("FAIL : stream did not reach time 2 at x = 3\n");
+        pass &= ok;
+    }
+    return pass;
+}
+
+// Advecting an interval again, that all streams have already passed, must not
+// prepare (and so load) any of its time windows.
+//
+bool TestPassedWindowsAreSkipped()
+{
+    UniformFlow   flow(4);
+    CountingField field(flow.field);
+    Advection     adv;
+    adv.UseSeedParticles({Particle(1.f, 5.f, 5.f, 0.0)});
+    adv.AdvectTillTime(&field, 0.0, 0.1, 2.0, true, Advection::ADVECTION_METHOD::RK4);
+
+    field.Reset();
+    adv.AdvectTillTime(&field, 0.0, 0.1, 1.0, true, Advection::ADVECTION_METHOD::RK4);
+    adv.AdvectTillTime(&field, 1.0, 0.1, 2.0, true, Advection::ADVECTION_METHOD::RK4);
+    bool pass = field.PreparedWindows().empty() && field.Evaluations() == 0;
+    std::printf("Replayed intervals: %ld windows prepared\n", field.PreparedWindows().size());
+
+    adv.AdvectTillTime(&field, 2.0, 0.1, 3.0, true, Advection::ADVECTION_METHOD::RK4);
+    const auto &windows = field.PreparedWindows();
+    pass &= windows.size() == 1 && windows[0].t0 == 2.0 && windows[0].t1 == 3.0;
+    std::printf("New interval: %ld windows prepared\n", windows.size());
+
+    if (!pass) std::printf("FAIL : passed windows were prepared, or the new one was not\n");
+    return pass;
+}
+
+// Advecting across several time steps in one call, as FlowRenderer does, asks the
+// field to load each next time step ahead of time, except after the last window.
+//
+bool TestNextWindowIsPrefetched()
+{
+    UniformFlow   flow(4);
+    CountingField field(flow.field);
+    Advection     adv;
+    adv.UseSeedParticles({Particle(1.f, 5.f, 5.f, 0.0)});
+    adv.AdvectTillTime(&field, 0.0, 0.1, 3.0, true, Advection::ADVECTION_METHOD::RK4);
+
+    const auto &windows = field.PreparedWindows();
+    bool        pass = windows.size() == 3;
+    for (size_t i = 0; pass && i < windows.size(); i++) {
+        std::printf("Window [%g, %g], prefetch next: %d\n", windows[i].t0, windows[i].t1, int(windows[i].prefetchNext));
+        pass &= windows[i].t0 == double(i) && windows[i].t1 == double(i + 1) && windows[i].prefetchNext == (i + 1 < windows.size());
+    }
+
+    if (!pass) std::printf("FAIL : the next time steps were not prefetched\n");
+    return pass;
+}
+
+int main(int argc, char *argv[])
+{
+    bool pass = true;
+    pass &= TestFixedStepsAcrossTimesteps();
+    pass &= TestPassedWindowsAreSkipped();
+    pass &= TestNextWindowIsPrefetched();
+
+    std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
@@ -311,6 +311,47 @@ void test_iterator(const StructuredGrid *sg)
     cout << endl;
 }
 
+void test_block_run(const StructuredGrid *sg)
+{
+    cout << "Block Run Test ----->" << endl;
+
+    double t0 = Wasp::GetTime();
+
+    double accum = 0.0;
+    size_t count = 0;
+    sg->ForEachBlockRun([&accum, &count](const float *values, size_t n, const DimsType &index) {
+        float sum = 0.0;
+        for (size_t i = 0; i < n; i++) { sum += values[i]; }
+        accum += sum;
+        count += n;
+    });
+    cout << "Iteration time : " << Wasp::GetTime() - t0 << endl;
+    cout << "Sum and count: " << accum << " " << count << endl;
+
+    // Compare element by element with the value iterator over a
+    // sub-region that does not align with block boundaries
+    //
+    const DimsType &dims = sg->GetDimensions();
+    DimsType        min = {dims[0] / 3, dims[1] / 3, dims[2] / 3};
+    DimsType        max = {dims[0] - 1 - dims[0] / 5, dims[1] - 1 - dims[1] / 5, dims[2] - 1 - dims[2] / 5};
+
+    bool   mismatch = false;
+    size_t regionCount = 0;
+    sg->ForEachBlockRun(min, max, [sg, &mismatch, &regionCount](const float *values, size_t n, const DimsType &index) {
+        for (size_t i = 0; i < n; i++) {
+            if (values[i] != sg->AccessIJK(index[0] + i, index[1], index[2])) mismatch = true;
+        }
+        regionCount += n;
+    });
+    size_t expected = (max[0] - min[0] + 1) * (max[1] - min[1] + 1) * (max[2] - min[2] + 1);
+    if (!mismatch && regionCount == expected) {
+        cout << "ForEachBlockRun AccessIJK match" << endl;
+    } else {
+        cout << "FAIL : ForEachBlockRun AccessIJK mismatch" << endl;
+    }
+    cout << endl;
+}
+
 void test_operator_pg_iterator(const StructuredGrid *sg)
 {
     cout << "Operator += Test ----->" << endl;
@@ -655,6 +696,8 @@ int main(int argc, char **argv)
 
     test_iterator(sg);
 
+    test_block_run(sg);
+
     test_operator_pg_iterator(sg);
 
     test_node_iterator(sg);
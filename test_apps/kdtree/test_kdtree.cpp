@@ -0,0 +1,235 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include "vapor/VAssert.h"
+
+#include <vapor/CFuncs.h>
+#include <vapor/OptionParser.h>
+#include <vapor/RegularGrid.h>
+#include <vapor/KDTreeRG.h>
+#include <vapor/utils.h>
+#include <vapor/FileUtils.h>
+
+using namespace Wasp;
+using namespace VAPoR;
+
+struct {
+    std::vector<size_t>     dims;
+    int                     nqueries;
+    int                     k;
+    int                     seed;
+    OptionParser::Boolean_T help;
+} opt;
+
+OptionParser::OptDescRec_T set_opts[] = {{"dims", 1, "23:17:9",
+                                          "Colon delimited 3-element vector "
+                                          "specifying grid dimensions"},
+                                         {"nqueries", 1, "2000", "Number of query points"},
+                                         {"k", 1, "5", "Number of nearest neighbors to find"},
+                                         {"seed", 1, "12345", "Random number generator seed"},
+                                         {"help", 0, "", "Print this message and exit"},
+                                         {NULL}};
+
+OptionParser::Option_T get_options[] = {{"dims", Wasp::CvtToSize_tVec, &opt.dims, sizeof(opt.dims)},
+                                        {"nqueries", Wasp::CvtToInt, &opt.nqueries, sizeof(opt.nqueries)},
+                                        {"k", Wasp::CvtToInt, &opt.k, sizeof(opt.k)},
+                                        {"seed", Wasp::CvtToInt, &opt.seed, sizeof(opt.seed)},
+                                        {"help", Wasp::CvtToBoolean, &opt.help, sizeof(opt.help)},
+                                        {NULL}};
+
+namespace {
+vector<float *> Heap;
+};
+
+const char *ProgName;
+
+// A single block grid whose values are set by the caller
+//
+RegularGrid *make_coord_grid(const vector<size_t> &dims)
+{
+    size_t n = 1;
+    for (auto d : dims) n *= d;
+
+    float *buf = new float[n];
+    Heap.push_back(buf);
+
+    return (new RegularGrid(dims, dims, {buf}, vector<double>(dims.size(), 0.0), vector<double>(dims.size(), 1.0)));
+}
+
+// Compare the batch k-nearest search of "tree" against a brute force search
+// over "points" (n points with ncoords coordinates each, interleaved) for
+// query points drawn from "points" jittered by up to "jitter". Returns the
+// number of mismatches.
+//
+int test_nearest(const KDTreeRG &tree, const vector<float> &points, int ncoords, float jitter, const string &label)
+{
+    const size_t npoints = points.size() / ncoords;
+    const size_t nq = opt.nqueries;
+    const size_t k = std::min((size_t)opt.k, npoints);
+
+    std::mt19937                          gen(opt.seed);
+    std::uniform_int_distribution<size_t> pick(0, npoints - 1);
+    std::uniform_real_distribution<float> noise(-jitter, jitter);
+
+    // Half the queries are exactly on grid points, the other half near them
+    //
+    vector<float> queries(nq * ncoords);
+    for (size_t q = 0; q < nq; q++) {
+        size_t p = pick(gen);
+        for (int c = 0; c < ncoords; c++) queries[q * ncoords + c] = points[p * ncoords + c] + (q % 2 ? noise(gen) : 0.f);
+    }
+
+    vector<size_t> indices(nq * k);
+    vector<float>  distances(nq * k);
+    tree.Nearest(queries.data(), nq, k, indices.data(), distances.data());
+
+    auto dist2 = [&](size_t q, size_t p) {
+        float d = 0.f;
+        for (int c = 0; c < ncoords; c++) {
+            float delta = queries[q * ncoords + c] - points[p * ncoords + c];
+            d += delta * delta;
+        }
+        return (d);
+    };
+    auto same = [](float a, float b) { return (std::abs(a - b) <= 1e-5f * std::max(1.f, std::max(a, b))); };
+
+    int           nerrors = 0;
+    vector<float> all(npoints);
+    for (size_t q = 0; q < nq; q++) {
+        for (size_t p = 0; p < npoints; p++) all[p] = dist2(q, p);
+        std::partial_sort(all.begin(), all.begin() + k, all.end());
+
+        const size_t *idx = &indices[q * k];
+        const float * dst = &distances[q * k];
+        bool          ok = true;
+        for (size_t i = 0; i < k; i++) {
+            // The i'th nearest distance matches brute force, and the index
+            // returned is at that distance. Ties may come in any order.
+            //
+            if (idx[i] >= npoints || !same(dst[i], all[i]) || !same(dist2(q, idx[i]), dst[i])) ok = false;
+            if (i > 0 && dst[i] < dst[i - 1]) ok = false;
+            if (std::find(idx, idx + i, idx[i]) != idx + i) ok = false;
+        }
+        if (!ok) nerrors++;
+    }
+
+    // The single point query agrees with the batch query
+    //
+    vector<double> coordu(queries.begin(), queries.begin() + ncoords);
+    vector<size_t> ijk;
+    tree.Nearest(coordu, ijk);
+    if (!same(dist2(0, LinearizeCoords(ijk, tree.GetDimensions())), distances[0])) nerrors++;
+
+    cout << label << " : " << nq << " queries, k = " << k << ", " << nerrors << " mismatches" << endl;
+    return (nerrors);
+}
+
+// A curvilinear 2D mesh: a sheared and warped unit square
+//
+int test_2d()
+{
+    vector<size_t> dims2d = {opt.dims[0], opt.dims[1]};
+    RegularGrid *  xrg = make_coord_grid(dims2d);
+    RegularGrid *  yrg = make_coord_grid(dims2d);
+
+    vector<float> points;
+    for (size_t j = 0; j < dims2d[1]; j++) {
+        for (size_t i = 0; i < dims2d[0]; i++) {
+            double u = (double)i / (dims2d[0] - 1);
+            double v = (double)j / (dims2d[1] - 1);
+            double x = u + 0.3 * v + 0.05 * sin(2.0 * M_PI * v);
+            double y = v + 0.1 * sin(2.0 * M_PI * u);
+            xrg->SetValueIJK(i, j, 0, x);
+            yrg->SetValueIJK(i, j, 0, y);
+            points.push_back(x);
+            points.push_back(y);
+        }
+    }
+
+    KDTreeRG tree(*xrg, *yrg);
+    int      nerrors = test_nearest(tree, points, 2, 0.05f, "2D curvilinear");
+
+    delete xrg;
+    delete yrg;
+    return (nerrors);
+}
+
+// A curvilinear 3D mesh: the 2D mesh above, with terrain following layers
+//
+int test_3d()
+{
+    RegularGrid *xrg = make_coord_grid(opt.dims);
+    RegularGrid *yrg = make_coord_grid(opt.dims);
+    RegularGrid *zrg = make_coord_grid(opt.dims);
+
+    vector<float> points;
+    for (size_t k = 0; k < opt.dims[2]; k++) {
+        for (size_t j = 0; j < opt.dims[1]; j++) {
+            for (size_t i = 0; i < opt.dims[0]; i++) {
+                double u = (double)i / (opt.dims[0] - 1);
+                double v = (double)j / (opt.dims[1] - 1);
+                double w = (double)k / (opt.dims[2] - 1);
+                double x = u + 0.3 * v + 0.05 * sin(2.0 * M_PI * v);
+                double y = v + 0.1 * sin(2.0 * M_PI * u);
+                double terrain = 0.2 * sin(M_PI * u) * sin(M_PI * v);
+                double z = terrain + w * (1.0 - terrain);
+                xrg->SetValueIJK(i, j, k, x);
+                yrg->SetValueIJK(i, j, k, y);
+                zrg->SetValueIJK(i, j, k, z);
+                points.push_back(x);
+                points.push_back(y);
+                points.push_back(z);
+            }
+        }
+    }
+
+    KDTreeRG tree(*xrg, *yrg, *zrg);
+    int      nerrors = test_nearest(tree, points, 3, 0.05f, "3D curvilinear");
+
+    delete xrg;
+    delete yrg;
+    delete zrg;
+    return (nerrors);
+}
+
+int main(int argc, char **argv)
+{
+    OptionParser op;
+
+    ProgName = FileUtils::LegacyBasename(argv[0]);
+
+    MyBase::SetErrMsgFilePtr(stderr);
+
+    if (op.AppendOptions(set_opts) < 0) {
+        cerr << ProgName << " : " << op.GetErrMsg();
+        exit(1);
+    }
+
+    if (op.ParseOptions(&argc, argv, get_options) < 0) {
+        cerr << ProgName << " : " << op.GetErrMsg();
+        exit(1);
+    }
+
+    if (opt.help) {
+        cerr << "Usage: " << ProgName << " [options]" << endl;
+        op.PrintOptionHelp(stderr);
+        exit(0);
+    }
+
+    if (opt.dims.size() != 3 || opt.dims[0] < 2 || opt.dims[1] < 2 || opt.dims[2] < 2 || opt.k < 1 || opt.nqueries < 1) {
+        cerr << ProgName << " : invalid options" << endl;
+        exit(1);
+    }
+
+    int nerrors = test_2d();
+    nerrors += test_3d();
+
+    for (int i = 0; i < Heap.size(); i++) { delete[] Heap[i]; }
+
+    cout << (nerrors ? "FAIL" : "PASS") << endl;
+    return (nerrors ? 1 : 0);
+}